@@ -0,0 +1,5800 @@
+#ifndef THERMO_ENGINE_H
+#define THERMO_ENGINE_H
+
+// ═══════════════════════════════════════════════════════════════════════════
+//                    TERMODINÂMICA DOS PRIMOS — MOTOR
+//           Crivos, Miller-Rabin, acumuladores, checkpoints e varredura
+//           Só C++17 e a biblioteca padrão (sem Qt): basta incluir este
+//           arquivo e compilar com -pthread
+// ═══════════════════════════════════════════════════════════════════════════
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define THERMO_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace thermo {
+
+// ======================= CONSTANTES FUNDAMENTAIS =======================
+
+namespace Constants {
+    // Hardy-Littlewood C₂ para twins (alta precisão)
+    constexpr long double C2 = 0.6601618158468695739278121100145557L;
+
+    // === MODELO CUMULATIVO ===
+    // kT_cum = a×ln²(p) + b×ln(p) + c
+    constexpr double kT_CUM_LN2 = 0.7784;
+    constexpr double kT_CUM_LN = -2.32;
+    constexpr double kT_CUM_C = -13.9;
+
+    // === MODELO LOCAL (por década) ===
+    // kT_local ≈ 0.75×ln²(p) - 17 (Hardy-Littlewood puro!)
+    constexpr double kT_LOC_LN2 = 0.7499;   // ≈ 1/(2C₂)
+    constexpr double kT_LOC_LN = -0.24;     // ≈ 0
+    constexpr double kT_LOC_C = -16.7;      // ≈ gap_min médio
+
+    // Offset para primos: gap_min = 2
+    constexpr double OFFSET_PRIMES = 2.0;
+
+    // Valor teórico do ratio kT/ln²(p) (assintótico local)
+    constexpr double RATIO_THEORETICAL = 0.7499;
+
+    // kT binário = 1/ln(2) ≈ 1.4427 (FIXO)
+    constexpr long double kT_BINARY = 1.4426950408889634073599246810018921L;
+    constexpr long double LN2 = 0.6931471805599453094172321214581766L;
+
+    // Limiares de regime (descoberta empírica)
+    constexpr uint64_t FROZEN_LIMIT = 500;          // ~17º twin, gaps = gap_min
+    constexpr uint64_t TRANSITION_LIMIT = 10000;    // transição inicial
+    constexpr uint64_t ASYMPTOTIC_LIMIT = 100000;   // regime assintótico bom
+    constexpr uint64_t PRECISE_LIMIT = 1000000;     // regime preciso (>99%)
+
+    // Classes válidas para twin primes mod 30
+    constexpr int TWIN_CLASSES[3] = {11, 17, 29};
+
+    // Matriz de gap_min entre classes mod 30
+    constexpr int GAP_MIN[3][3] = {
+        {30,  6, 18},  // de 11 → {11, 17, 29}
+        {24, 30, 12},  // de 17 → {11, 17, 29}
+        {12, 18, 30}   // de 29 → {11, 17, 29}
+    };
+
+    // Wheels mod M (210 nos crivos, 30030 no teste): os φ(M) resíduos
+    // coprimos com M, em ordem, e o passo de cada um para o seguinte (o do
+    // último leva a M + 1), gerados em tempo de compilação
+    constexpr int gcd(int a, int b) { return b == 0 ? a : gcd(b, a % b); }
+
+    constexpr int totient(int m)
+    {
+        int count = 0;
+        for (int r = 1; r <= m; ++r) count += gcd(r, m) == 1;
+        return count;
+    }
+
+    template <int SIZE>
+    struct WheelTable {
+        int offsets[SIZE] = {};
+        uint8_t deltas[SIZE] = {};
+    };
+
+    template <int M, int SIZE>
+    constexpr WheelTable<SIZE> buildWheel()
+    {
+        WheelTable<SIZE> t{};
+        for (int r = 1, n = 0; r < M; ++r)
+            if (gcd(r, M) == 1) t.offsets[n++] = r;
+        for (int i = 0; i < SIZE; ++i)
+            t.deltas[i] = static_cast<uint8_t>((i + 1 < SIZE ? t.offsets[i + 1] : M + 1) - t.offsets[i]);
+        return t;
+    }
+
+    template <int M>
+    struct Wheel {
+        static constexpr int MODULUS = M;
+        static constexpr int SIZE = totient(M);
+        static constexpr WheelTable<SIZE> T = buildWheel<M, SIZE>();
+    };
+
+    // Wheel mod 210 = 2×3×5×7: 48 coprimos, o layout dos crivos
+    constexpr int WHEEL_SIZE = Wheel<210>::SIZE;
+    constexpr const int (&WHEEL_OFFSETS)[WHEEL_SIZE] = Wheel<210>::T.offsets;
+    static_assert(WHEEL_SIZE == 48 && WHEEL_OFFSETS[1] == 11 && WHEEL_OFFSETS[47] == 209,
+                  "wheel mod 210");
+
+    // v₂ teórico (distribuição geométrica)
+    constexpr double V2_MEAN_THEORETICAL = 2.0;
+    constexpr double V2_P1_THEORETICAL = 0.5;
+    constexpr double V2_P2_THEORETICAL = 0.25;
+    constexpr double V2_P3_THEORETICAL = 0.125;
+}
+
+// ======================= MODELOS =======================
+
+enum class AnalysisMode { Primes, Twins, Both };
+
+// Regime do sistema
+enum class Regime {
+    Frozen,      // p < 500, gaps = gap_min
+    Transition,  // 500 < p < 10k
+    Asymptotic,  // 10k < p < 1M
+    Precise      // p > 1M, lei vale com R² > 0.99
+};
+
+inline const char* regimeName(Regime r) {
+    switch (r) {
+        case Regime::Frozen: return "CONGELADO";
+        case Regime::Transition: return "TRANSIÇÃO";
+        case Regime::Asymptotic: return "ASSINTÓTICO";
+        case Regime::Precise: return "PRECISO ✓";
+    }
+    return "?";
+}
+
+// Candidatos acima de 2⁶⁴: janelas de amostragem, BPSW e WideWheelIterator
+using uint128_t = __uint128_t;
+constexpr uint128_t MAX_UINT128 = ~uint128_t(0);
+
+// Soma exata de grandezas inteiras (gaps, excessos, v₂). 128 bits não
+// estouram nem arredondam; a conversão para ponto flutuante só acontece
+// quando um snapshot (Stats) é montado.
+using ExactSum = __uint128_t;
+
+inline double meanOf(ExactSum sum, uint64_t count) {
+    return count > 0 ? static_cast<double>(static_cast<long double>(sum) / count) : 0.0;
+}
+
+// Índice de classe mod 30 para twins
+inline int classIndex(uint64_t p) {
+    int r = p % 30;
+    if (r == 11) return 0;
+    if (r == 17) return 1;
+    if (r == 29) return 2;
+    return -1;
+}
+
+// Ajuste de máxima verossimilhança de P(gap) ∝ exp(−(gap − gap_min)/kT) a
+// uma transição. O excesso gap − gap_min é sempre múltiplo de 30, então o
+// modelo discreto é geométrico em k = excesso/30: P(k) = (1 − q)·qᵏ com
+// q = exp(−30/kT). A média m de k é estatística suficiente, q̂ = m/(1 + m)
+// e kT̂ = 30/ln(1 + 1/m); o IC de 95% vem do IC de m (Var k = m(1 + m)).
+// A aderência é o χ² do histograma contra a geométrica ajustada, com os bins
+// agrupados até esperarem ≥ 5 twins; o valor-p usa Wilson-Hilferty.
+struct BoltzmannFit {
+    uint64_t count = 0;
+    double kT = 0.0;
+    double kTLow = 0.0;
+    double kTHigh = 0.0;
+    double chi2 = 0.0;
+    int dof = 0;              // 0 = sem bins suficientes para o teste
+    double pValue = 0.0;
+};
+
+struct TransitionStats {
+    // Histograma de k = (gap − gap_min)/30 por transição; o último bin é a
+    // cauda k ≥ EXCESS_BINS. 9 × 257 contadores (18 KiB) ficam no cache.
+    static constexpr int EXCESS_BINS = 256;
+
+    uint64_t count[3][3] = {{0}};
+    ExactSum sumGap[3][3] = {{0}};
+    uint64_t excessHistogram[3][3][EXCESS_BINS + 1] = {};
+
+    void add(int c1, int c2, uint64_t gap)
+    {
+        ++count[c1][c2];
+        sumGap[c1][c2] += gap;
+        const uint64_t k = (gap - Constants::GAP_MIN[c1][c2]) / 30;
+        ++excessHistogram[c1][c2][std::min<uint64_t>(k, EXCESS_BINS)];
+    }
+
+    void merge(const TransitionStats &other)
+    {
+        for (int c1 = 0; c1 < 3; ++c1) {
+            for (int c2 = 0; c2 < 3; ++c2) {
+                count[c1][c2] += other.count[c1][c2];
+                sumGap[c1][c2] += other.sumGap[c1][c2];
+                for (int k = 0; k <= EXCESS_BINS; ++k)
+                    excessHistogram[c1][c2][k] += other.excessHistogram[c1][c2][k];
+            }
+        }
+    }
+
+    double avgGap(int c1, int c2) const {
+        return meanOf(sumGap[c1][c2], count[c1][c2]);
+    }
+
+    BoltzmannFit fit(int c1, int c2) const
+    {
+        BoltzmannFit f;
+        const uint64_t n = count[c1][c2];
+        f.count = n;
+        if (n < 2) return f;
+
+        // m = ⟨k⟩, exato a partir da soma dos gaps (não depende da cauda)
+        const ExactSum sumExcess = sumGap[c1][c2] - ExactSum(n) * Constants::GAP_MIN[c1][c2];
+        const double m = meanOf(sumExcess, n) / 30.0;
+        if (m <= 0) return f;   // todos os gaps em gap_min (regime congelado)
+
+        auto kTOf = [](double mean) { return mean > 0 ? 30.0 / std::log1p(1.0 / mean) : 0.0; };
+        const double halfWidth = 1.959963984540054 * std::sqrt(m * (1.0 + m) / n);
+        f.kT = kTOf(m);
+        f.kTLow = kTOf(m - halfWidth);
+        f.kTHigh = kTOf(m + halfWidth);
+
+        // χ² com grupos de bins consecutivos que esperam ≥ 5 twins; o que
+        // sobra no fim (cauda incluída) entra no último grupo
+        const double q = m / (1.0 + m);
+        const uint64_t *h = excessHistogram[c1][c2];
+        double expected = 0, observed = 0, pk = n * (1.0 - q);
+        double lastE = 0, lastO = 0;
+        int groups = 0;
+        for (int k = 0; k <= EXCESS_BINS; ++k) {
+            expected += k < EXCESS_BINS ? pk : pk / (1.0 - q);   // cauda: n·q^B
+            observed += static_cast<double>(h[k]);
+            pk *= q;
+            if (expected >= 5.0 || k == EXCESS_BINS) {
+                if (expected < 5.0 && groups > 0) {
+                    // cauda pequena demais: junta ao grupo anterior
+                    f.chi2 -= (lastO - lastE) * (lastO - lastE) / lastE;
+                    expected += lastE;
+                    observed += lastO;
+                    --groups;
+                }
+                if (expected > 0)
+                    f.chi2 += (observed - expected) * (observed - expected) / expected;
+                lastE = expected;
+                lastO = observed;
+                ++groups;
+                expected = observed = 0;
+            }
+        }
+
+        // graus de liberdade: grupos − 1 (total fixo) − 1 (kT ajustado)
+        f.dof = groups - 2;
+        if (f.dof < 1) {
+            f.dof = 0;
+            f.chi2 = 0;
+            return f;
+        }
+        const double d = f.dof;
+        const double z = (std::cbrt(f.chi2 / d) - (1.0 - 2.0 / (9.0 * d))) / std::sqrt(2.0 / (9.0 * d));
+        f.pValue = 0.5 * std::erfc(z / std::sqrt(2.0));
+        return f;
+    }
+
+    double probability(int c1, int c2) const {
+        uint64_t total = 0;
+        for (int j = 0; j < 3; ++j) total += count[c1][j];
+        return total > 0 ? static_cast<double>(count[c1][c2]) / total : 0.0;
+    }
+};
+
+// Gap máximo: maior que todos os anteriores da varredura, com o p em que
+// começa. Cramér conjectura gap = O(ln²p); a razão gap/ln²p é a de
+// Cramér-Shanks-Granville.
+struct GapRecord {
+    uint64_t p = 0;
+    uint64_t gap = 0;
+
+    double cramerRatio() const {
+        const double ln = std::log(static_cast<double>(p));
+        return ln > 0 ? gap / (ln * ln) : 0.0;
+    }
+};
+
+// Recordes de gap em ordem crescente. add() custa uma comparação por gap;
+// só um recorde novo (O(ln p) ao todo) toca o vector.
+struct GapRecords {
+    static constexpr uint64_t MAX_RECORDS = 4096;   // limite de sanidade do checkpoint
+
+    uint64_t maxGap = 0;
+    std::vector<GapRecord> records;
+
+    void add(uint64_t p, uint64_t gap)
+    {
+        if (gap > maxGap) push(p, gap);
+    }
+
+    // Anexa os recordes do trecho imediatamente seguinte: um recorde local
+    // de next só é global se vencer o maior gap até aqui
+    void merge(const GapRecords &next)
+    {
+        for (const GapRecord &r : next.records)
+            add(r.p, r.gap);
+    }
+
+    // Maior gap/ln²p entre os recordes
+    GapRecord maxRatio() const
+    {
+        GapRecord best;
+        for (const GapRecord &r : records)
+            if (best.gap == 0 || r.cramerRatio() > best.cramerRatio()) best = r;
+        return best;
+    }
+
+    template <class IO>
+    void serialize(IO &io)
+    {
+        uint64_t n = records.size();
+        io(n);
+        if (n > MAX_RECORDS) {
+            io.ok = false;
+            return;
+        }
+        records.resize(n);
+        for (GapRecord &r : records) {
+            io(r.p); io(r.gap);
+        }
+        maxGap = records.empty() ? 0 : records.back().gap;
+    }
+
+private:
+    void push(uint64_t p, uint64_t gap)
+    {
+        maxGap = gap;
+        records.push_back({p, gap});
+    }
+};
+
+// Fronteiras dos bins logarítmicos do kT local: binsPerDecade bins por década,
+// de 10³ até o fim do uint64. As fronteiras são inteiras e calculadas uma vez,
+// então achar o bin de um twin não custa nenhum log; o acumulador guarda o bin
+// corrente e, como a varredura só avança, quase sempre basta uma comparação.
+class LogBinLayout {
+public:
+    static constexpr int FIRST_DECADE = 3;              // bin 0 começa em 10³
+    static constexpr int DEFAULT_BINS_PER_DECADE = 100;
+    static constexpr int MAX_BINS_PER_DECADE = 10000;
+
+    // Layout compartilhado (imutável) para binsPerDecade bins por década
+    static const LogBinLayout &get(int binsPerDecade)
+    {
+        static std::mutex mutex;
+        static std::map<int, std::unique_ptr<LogBinLayout>> layouts;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &layout = layouts[binsPerDecade];
+        if (!layout) layout.reset(new LogBinLayout(binsPerDecade));
+        return *layout;
+    }
+
+    static const LogBinLayout &standard()
+    {
+        static const LogBinLayout &layout = get(DEFAULT_BINS_PER_DECADE);
+        return layout;
+    }
+
+    int binsPerDecade() const { return m_perDecade; }
+    int size() const { return static_cast<int>(m_meanLn2.size()); }
+
+    // Bin i = [lower(i), upper(i))
+    uint64_t lower(int i) const { return m_bounds[i]; }
+    uint64_t upper(int i) const { return m_bounds[i + 1]; }
+    int decade(int i) const { return m_decade[i]; }
+
+    // Bin que contém p; -1 abaixo de 10³
+    int find(uint64_t p) const
+    {
+        auto it = std::upper_bound(m_bounds.begin(), m_bounds.end(), p);
+        return std::min(static_cast<int>(it - m_bounds.begin()) - 1, size() - 1);
+    }
+
+    // ⟨ln²p⟩ sobre os twins do bin, com a densidade de Hardy-Littlewood
+    // ∝ 1/ln²p: (b − a) / ∫ₐᵇ dp/ln²p
+    double meanLn2(int i) const { return m_meanLn2[i]; }
+
+    // ⟨ln²p⟩ dos twins em [a, b) com a densidade de Hardy-Littlewood
+    static double twinMeanLn2(uint128_t a, uint128_t b) { return meanLnPow(a, b, 2); }
+
+    // ⟨(ln p)^k⟩ das k-uplas em [a, b), com densidade ∝ 1/(ln p)^k:
+    // ∫ dp/(ln p)^k = a·∫ eˢ/(ln a + s)^k ds com s = ln(p/a), por Simpson.
+    // Medir a partir de a mantém b − a exato mesmo quando é menor que o ulp
+    // de a (janelas de 10⁸ acima de 10²⁸)
+    static double meanLnPow(uint128_t a, uint128_t b, int k)
+    {
+        const int steps = 64;
+        const long double ta = std::log(static_cast<long double>(a));
+        const long double width = static_cast<long double>(b - a);
+        const long double h = std::log1p(width / static_cast<long double>(a)) / steps;
+        auto f = [ta, k](long double s) {
+            long double lnPow = ta + s;
+            for (int i = 1; i < k; ++i) lnPow *= ta + s;
+            return std::exp(s) / lnPow;
+        };
+        long double sum = f(0) + f(steps * h);
+        for (int j = 1; j < steps; ++j)
+            sum += f(j * h) * (j % 2 ? 4 : 2);
+        const long double integral = sum * h / 3;
+        return static_cast<double>(width / (static_cast<long double>(a) * integral));
+    }
+
+private:
+    explicit LogBinLayout(int binsPerDecade)
+        : m_perDecade(binsPerDecade)
+    {
+        // Fronteiras ⌈10^(d + k/B)⌉, com as potências de 10 exatas; nas décadas
+        // baixas, bins que cairiam no mesmo inteiro são fundidos. O último bin
+        // vai até 2⁶⁴ − 1.
+        const long double top = std::ldexp(1.0L, 64);
+        uint64_t decadeStart = 1000;
+        for (int d = FIRST_DECADE;; ++d, decadeStart *= 10) {
+            for (int k = 0; k < m_perDecade; ++k) {
+                const long double x = decadeStart * std::pow(10.0L, static_cast<long double>(k) / m_perDecade);
+                if (x >= top) break;
+                const uint64_t bound = k == 0 ? decadeStart : static_cast<uint64_t>(std::ceil(x));
+                if (!m_bounds.empty() && bound <= m_bounds.back()) continue;
+                m_bounds.push_back(bound);
+                m_decade.push_back(static_cast<uint8_t>(d));
+            }
+            if (decadeStart > UINT64_MAX / 10) break;
+        }
+        m_bounds.push_back(UINT64_MAX);
+
+        for (size_t i = 0; i + 1 < m_bounds.size(); ++i)
+            m_meanLn2.push_back(twinMeanLn2(m_bounds[i], m_bounds[i + 1]));
+    }
+
+    int m_perDecade;
+    std::vector<uint64_t> m_bounds;    // size() + 1 fronteiras
+    std::vector<uint8_t> m_decade;     // log10 do início de cada bin
+    std::vector<double> m_meanLn2;
+};
+
+// Um bin logarítmico: transições de twin cujo p inicial cai nele
+struct LogBin {
+    uint64_t count = 0;
+    ExactSum sumExcess = 0;
+
+    double kT() const { return meanOf(sumExcess, count); }
+};
+
+// Stats por década (10³, 10⁴, ...), agregadas dos bins logarítmicos
+struct DecadeStats {
+    uint64_t count = 0;
+    ExactSum sumExcess = 0;
+    long double sumLn2 = 0;
+
+    double kT() const {
+        return meanOf(sumExcess, count);
+    }
+
+    double avgLn2() const {
+        return count > 0 ? static_cast<double>(sumLn2 / count) : 0;
+    }
+
+    double ratio() const {
+        double ln2 = avgLn2();
+        return (count > 0 && ln2 > 0) ? kT() / ln2 : 0;
+    }
+
+    double pctTheoretical() const {
+        return ratio() / Constants::RATIO_THEORETICAL * 100.0;
+    }
+};
+
+struct Stats {
+    uint64_t currentN = 0;
+    uint64_t primeCount = 0;
+    uint64_t twinCount = 0;
+
+    Regime regime = Regime::Frozen;
+
+    // Gaps médios
+    double avgPrimeGap = 0.0;
+    double avgTwinGap = 0.0;
+
+    // kT Primos: kT = ⟨gap⟩ - 2
+    double kTPrimeEmpirical = 0.0;
+    double kTPrimeTheoretical = 0.0;
+
+    // kT Twins
+    double kTTwinEmpirical = 0.0;
+    double kTTwinTheoretical = 0.0;
+    double kTTwinAsymptotic = 0.0;
+    uint64_t asymptoticCount = 0;
+
+    // Razão kT/ln²(p)
+    double kTRatio = 0.0;
+
+    // kT Binário
+    double kTBinary = Constants::kT_BINARY;
+
+    // v₂(p+1)
+    double meanV2 = 0.0;
+    uint64_t v2Histogram[8] = {0};
+
+    // v₂(gap) - trailing zeros do gap entre twins
+    double meanV2Gap = 0.0;
+    uint64_t v2GapHistogram[8] = {0};
+
+    // Correlação v₂(p+1) vs v₂(gap)
+    double corrV2 = 0.0;
+
+    // Transições mod 30
+    TransitionStats transitions;
+
+    // R² de Boltzmann (consistência entre transições)
+    double boltzmannR2 = 0.0;
+
+    // Ajuste MLE de Boltzmann de cada transição (histogramas em transitions)
+    BoltzmannFit boltzmannFit[3][3];
+
+    // Gaps máximos (Cramér): entre primos consecutivos e entre twins consecutivos
+    GapRecords primeGapRecords;
+    GapRecords twinGapRecords;
+
+    // kT local em bins logarítmicos; bins[i] é o bin i de binLayout (o vetor
+    // só vai até o último bin com twins)
+    const LogBinLayout *binLayout = &LogBinLayout::standard();
+    std::vector<LogBin> bins;
+
+    // Década 10^log10 agregada dos bins
+    DecadeStats decade(int log10) const
+    {
+        DecadeStats d;
+        for (int i = 0; i < static_cast<int>(bins.size()); ++i) {
+            if (binLayout->decade(i) != log10) continue;
+            d.count += bins[i].count;
+            d.sumExcess += bins[i].sumExcess;
+            d.sumLn2 += static_cast<long double>(bins[i].count) * binLayout->meanLn2(i);
+        }
+        return d;
+    }
+
+    // Maior década com bins (LogBinLayout::FIRST_DECADE − 1 se nenhuma)
+    int lastDecade() const
+    {
+        return bins.empty() ? LogBinLayout::FIRST_DECADE - 1
+                            : binLayout->decade(static_cast<int>(bins.size()) - 1);
+    }
+};
+
+// ======================= INSTRUMENTAÇÃO =======================
+
+// Contadores por thread e cronômetros de fase para perfilar varreduras de
+// produção sem perf. Cada thread escreve só no próprio slot (load + store
+// relaxados, sem RMW nem linha de cache disputada); snapshot() soma os slots
+// vivos e os de threads já encerradas. Os cronômetros usam steady_clock e
+// envolvem trabalho por segmento (milissegundos), nunca por número.
+// Compilar com -DTHERMO_PROFILE=0 remove tudo: add() e PhaseTimer viram nada.
+#ifndef THERMO_PROFILE
+#define THERMO_PROFILE 1
+#endif
+
+namespace Profile {
+    enum Counter : int {
+        SEGMENTS,     // segmentos de crivo processados
+        CANDIDATES,   // posições da wheel cobertas por eles
+        PRIMES,       // primos enumerados pela varredura
+        TWINS,        // twins enumerados pela varredura
+        REPORTS,      // Stats publicadas para a GUI ou o batch
+        MR_CALLS,     // testes Miller-Rabin (isPrimeFromWheel além de 121)
+        COUNTER_COUNT
+    };
+
+    enum Phase : int {
+        SIEVE,        // nextSegment (crivo ou leitura do cache)
+        ACCUMULATE,   // enumeração do bitmap + ScanAccumulator
+        REPORT,       // fillStats + publicação do snapshot
+        CHECKPOINT,   // checkpoint e flush da exportação
+        MERGE,        // costura dos blocos paralelos
+        PHASE_COUNT
+    };
+
+    // Compostos reprovados na base i do conjunto de testemunhas (i < MAX_WITNESSES)
+    constexpr int MAX_WITNESSES = 7;
+
+    constexpr int REJECT_BASE = COUNTER_COUNT;
+    constexpr int PHASE_BASE = REJECT_BASE + MAX_WITNESSES;
+    constexpr int SLOTS = PHASE_BASE + PHASE_COUNT;
+
+    inline const char *phaseName(int phase)
+    {
+        static const char *const names[PHASE_COUNT] = {
+            "sieve", "accumulate", "report", "checkpoint", "merge"
+        };
+        return names[phase];
+    }
+
+    struct Snapshot {
+        uint64_t v[SLOTS] = {};
+
+        uint64_t operator[](Counter c) const { return v[c]; }
+        uint64_t rejectedAt(int witness) const { return v[REJECT_BASE + witness]; }
+        double seconds(Phase p) const { return v[PHASE_BASE + p] / 1e9; }
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> v[SLOTS] = {};
+    };
+
+    // Slots das threads vivas; uma thread que termina soma o seu em retired
+    // e o devolve para reuso
+    class Registry {
+    public:
+        static Registry &instance()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        Slot *acquire()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_free.empty()) {
+                m_slots.emplace_back(new Slot);
+                return m_slots.back().get();
+            }
+            Slot *slot = m_free.back();
+            m_free.pop_back();
+            return slot;
+        }
+
+        void release(Slot *slot)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int i = 0; i < SLOTS; ++i) {
+                m_retired.v[i] += slot->v[i].load(std::memory_order_relaxed);
+                slot->v[i].store(0, std::memory_order_relaxed);
+            }
+            m_free.push_back(slot);
+        }
+
+        Snapshot snapshot()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Snapshot s = m_retired;
+            for (const auto &slot : m_slots)
+                for (int i = 0; i < SLOTS; ++i)
+                    s.v[i] += slot->v[i].load(std::memory_order_relaxed);
+            return s;
+        }
+
+        // Zera tudo; chamar sem varredura em andamento
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_retired = Snapshot{};
+            for (const auto &slot : m_slots)
+                for (int i = 0; i < SLOTS; ++i)
+                    slot->v[i].store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<Slot>> m_slots;
+        std::vector<Slot *> m_free;
+        Snapshot m_retired;
+    };
+
+    inline Slot &threadSlot()
+    {
+        struct Handle {
+            Slot *slot = Registry::instance().acquire();
+            ~Handle() { Registry::instance().release(slot); }
+        };
+        thread_local Handle handle;
+        return *handle.slot;
+    }
+
+    inline void add(int index, uint64_t delta = 1)
+    {
+#if THERMO_PROFILE
+        std::atomic<uint64_t> &c = threadSlot().v[index];
+        c.store(c.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+#else
+        (void)index;
+        (void)delta;
+#endif
+    }
+
+    inline Snapshot snapshot() { return Registry::instance().snapshot(); }
+    inline void reset() { Registry::instance().reset(); }
+    inline constexpr bool enabled() { return THERMO_PROFILE != 0; }
+
+    // Soma ao slot da fase o tempo de vida do objeto
+    class PhaseTimer {
+    public:
+#if THERMO_PROFILE
+        explicit PhaseTimer(Phase phase)
+            : m_phase(phase), m_start(std::chrono::steady_clock::now())
+        {
+        }
+        ~PhaseTimer()
+        {
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count();
+            add(PHASE_BASE + m_phase, static_cast<uint64_t>(ns));
+        }
+
+    private:
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+#else
+        explicit PhaseTimer(Phase) {}
+#endif
+    };
+}
+
+// ======================= MILLER-RABIN COM WHEEL MOD 210 =======================
+
+// Aritmética de Montgomery módulo n ímpar (R = 2^bits de U).
+// Valores ficam na forma x·R mod n; mul() reduz o produto sem divisão de
+// hardware — as únicas divisões acontecem uma vez por n, no construtor.
+template <typename U, typename W>
+struct Montgomery {
+    static constexpr int BITS = 8 * sizeof(U);
+
+    U n;
+    U nInv;     // n⁻¹ mod R
+    U r2;       // R² mod n
+    U one;      // R mod n  (1 na forma de Montgomery)
+    U minusOne; // n - one  (n-1 na forma de Montgomery)
+
+    explicit Montgomery(U modulus) : n(modulus) {
+        nInv = n;                                  // correto em 3 bits (n ímpar)
+        for (int bits = 3; bits < BITS; bits *= 2)
+            nInv *= U(2) - n * nInv;               // Newton: dobra os bits
+        one = U(U(0) - n) % n;
+        r2 = static_cast<U>(static_cast<W>(one) * one % n);
+        minusOne = n - one;
+    }
+
+    // REDC(t) para t < n·R: com m = t·n⁻¹ mod R, t ≡ m·n (mod R), então
+    // t·R⁻¹ ≡ hi(t) - hi(m·n) (mod n)
+    static U redc(W t, U n, U nInv) {
+        const U m = static_cast<U>(t) * nInv;
+        const U tHi = static_cast<U>(t >> BITS);
+        const U mnHi = static_cast<U>((static_cast<W>(m) * n) >> BITS);
+        return tHi >= mnHi ? tHi - mnHi : tHi - mnHi + n;
+    }
+
+    U mul(U a, U b) const { return redc(static_cast<W>(a) * b, n, nInv); }
+
+    U toMontgomery(U a) const { return mul(a, r2); }
+
+    U pow(U base, U exp) const {
+        U result = one;
+        while (exp > 0) {
+            if (exp & 1)
+                result = mul(result, base);
+            exp >>= 1;
+            base = mul(base, base);
+        }
+        return result;
+    }
+};
+
+using Montgomery32 = Montgomery<uint32_t, uint64_t>;
+using Montgomery64 = Montgomery<uint64_t, __uint128_t>;
+
+// Conjuntos mínimos de testemunhas por magnitude (Jaeschke 1993, Sinclair 2011)
+namespace Witnesses {
+    // n < 2^32: {2, 7, 61} vale até 4.759.123.141
+    constexpr uint32_t BELOW_2_32[] = {2, 7, 61};
+    // Prefixos de 5, 6 e 7 bases valem até 2.152.302.898.747,
+    // 3.474.749.660.383 e 341.550.071.728.321
+    constexpr uint32_t JAESCHKE[] = {2, 3, 5, 7, 11, 13, 17};
+    // Todo n < 2^64
+    constexpr uint32_t SINCLAIR[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+    struct Set {
+        const uint32_t *bases;
+        int count;
+    };
+
+    // Grupos de n ≥ 2^32, em ordem crescente de magnitude
+    constexpr int GROUPS_64 = 4;
+
+    inline int group64(uint64_t n) {
+        if (n < 2152302898747ULL) return 0;
+        if (n < 3474749660383ULL) return 1;
+        if (n < 341550071728321ULL) return 2;
+        return 3;
+    }
+
+    inline Set set64(int group) {
+        return group < 3 ? Set{JAESCHKE, 5 + group} : Set{SINCLAIR, 7};
+    }
+}
+
+// Miller-Rabin: teste de primalidade determinístico para n < 2^64
+// Usa o menor conjunto de testemunhas comprovado para a magnitude de n
+class MillerRabin {
+public:
+    static bool isPrime(uint64_t n) {
+        if (n < 2) return false;
+        if (n % 2 == 0) return n == 2;
+        if (n % 3 == 0) return n == 3;
+        if (n % 5 == 0) return n == 5;
+        if (n % 7 == 0) return n == 7;
+        return isPrimeFromWheel(n);
+    }
+
+    // Teste otimizado: assume que n já passou pelo filtro wheel mod 210
+    // (coprimo com 2, 3, 5, 7). As bases continuam sendo testadas: os
+    // conjuntos de Witnesses só são determinísticos com a lista completa.
+    static bool isPrimeFromWheel(uint64_t n) {
+        if (n < 121) return n > 1;  // 121 = 11², menor composto coprimo com 210
+
+        if (n <= UINT32_MAX)
+            return passesAll(Montgomery32(static_cast<uint32_t>(n)),
+                             Witnesses::Set{Witnesses::BELOW_2_32, 3});
+        return passesAll(Montgomery64(n), Witnesses::set64(Witnesses::group64(n)));
+    }
+
+    // Testa count candidatos de uma vez: out[i] = 1 se n[i] é primo.
+    // Os testes de cada base rodam em lanes paralelas (ver MILLER-RABIN EM LOTE).
+    static void isPrimeBatch(const uint64_t *n, size_t count, uint8_t *out);
+
+private:
+    // Todas as bases são < n nos caminhos acima (n ≥ 121 com 32 bits, n ≥ 2^32
+    // com 64), então nenhuma é ≡ 0 mod n e dispensam redução prévia
+    template <typename U, typename W>
+    static bool passesAll(const Montgomery<U, W> &mont, Witnesses::Set witnesses) {
+        // Escreve n-1 = 2^r * d onde d é ímpar
+        const U n = mont.n;
+        U d = n - 1;
+        int r = 0;
+        while ((d & 1) == 0) {
+            d >>= 1;
+            ++r;
+        }
+
+        Profile::add(Profile::MR_CALLS);
+        for (int i = 0; i < witnesses.count; ++i) {
+            const U a = mont.toMontgomery(static_cast<U>(witnesses.bases[i]));
+            if (!millerRabinTest(mont, d, r, a)) {
+                Profile::add(Profile::REJECT_BASE + i);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Um round do teste Miller-Rabin (base já na forma de Montgomery)
+    template <typename U, typename W>
+    static bool millerRabinTest(const Montgomery<U, W> &mont, U d, int r, U a) {
+        U x = mont.pow(a, d);
+
+        if (x == mont.one || x == mont.minusOne)
+            return true;
+
+        for (int i = 0; i < r - 1; ++i) {
+            x = mont.mul(x, x);
+            if (x == mont.minusOne)
+                return true;
+        }
+        return false;
+    }
+};
+
+// ======================= MILLER-RABIN EM LOTE =======================
+
+// Um lote é testado base por base: cada round roda a mesma base em todos os
+// candidatos ainda vivos e descarta os reprovados, de modo que os compostos
+// (quase todos caem na primeira base) não arrastam o resto do lote.
+//  - n < 2^32: Montgomery de 32 bits em lanes de 64 bits, 8 por vez com
+//    AVX-512 e 4 com AVX2 (_mm*_mul_epu32 faz o produto 32×32→64);
+//  - n ≥ 2^32: AVX2/AVX-512 não têm produto 64×64→128 por lane, então são
+//    4 lanes escalares intercaladas, que mantêm o multiplicador ocupado.
+// A exponenciação é da esquerda para a direita e sem desvios: toda lane
+// calcula x² e x²·a e escolhe pelo bit do seu expoente. Para a base 2, x²·2
+// é uma soma modular em vez de uma multiplicação de Montgomery.
+namespace MillerRabinBatch {
+    // Candidatos < 2^32 em SoA, com as constantes de Montgomery pré-calculadas.
+    // Os vetores são completados até múltiplo de LANE_PAD repetindo a última
+    // lane, para que os kernels vetoriais leiam blocos inteiros.
+    struct Lanes32 {
+        static constexpr size_t LANE_PAD = 8;
+
+        std::vector<uint32_t> n, nInv, one, r2, d, r;
+        std::vector<size_t> idx;    // posição no lote original
+        size_t count = 0;
+
+        void push(uint32_t modulus, size_t i) {
+            const Montgomery32 mont(modulus);
+            uint32_t dd = modulus - 1;
+            uint32_t rr = 0;
+            while ((dd & 1) == 0) {
+                dd >>= 1;
+                ++rr;
+            }
+            n.push_back(modulus);
+            nInv.push_back(mont.nInv);
+            one.push_back(mont.one);
+            r2.push_back(mont.r2);
+            d.push_back(dd);
+            r.push_back(rr);
+            idx.push_back(i);
+            ++count;
+        }
+
+        void pad() {
+            for (auto *v : {&n, &nInv, &one, &r2, &d, &r}) {
+                v->resize(count);
+                if (count > 0)
+                    v->resize((count + LANE_PAD - 1) / LANE_PAD * LANE_PAD, v->back());
+            }
+        }
+
+        // Mantém só as lanes aprovadas; as reprovadas são compostas
+        void keep(const uint8_t *pass, uint8_t *out) {
+            size_t kept = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (!pass[i]) {
+                    out[idx[i]] = 0;
+                    continue;
+                }
+                n[kept] = n[i]; nInv[kept] = nInv[i]; one[kept] = one[i];
+                r2[kept] = r2[i]; d[kept] = d[i]; r[kept] = r[i];
+                idx[kept] = idx[i];
+                ++kept;
+            }
+            count = kept;
+            idx.resize(kept);
+            pad();
+        }
+    };
+
+    // Candidatos ≥ 2^32 de um mesmo grupo de testemunhas
+    struct Lanes64 {
+        std::vector<Montgomery64> mont;
+        std::vector<uint64_t> d;
+        std::vector<int> r;
+        std::vector<size_t> idx;
+
+        size_t size() const { return idx.size(); }
+
+        void push(uint64_t modulus, size_t i) {
+            uint64_t dd = modulus - 1;
+            int rr = 0;
+            while ((dd & 1) == 0) {
+                dd >>= 1;
+                ++rr;
+            }
+            mont.emplace_back(modulus);
+            d.push_back(dd);
+            r.push_back(rr);
+            idx.push_back(i);
+        }
+
+        void keep(const uint8_t *pass, uint8_t *out) {
+            size_t kept = 0;
+            for (size_t i = 0; i < size(); ++i) {
+                if (!pass[i]) {
+                    out[idx[i]] = 0;
+                    continue;
+                }
+                mont[kept] = mont[i]; d[kept] = d[i]; r[kept] = r[i]; idx[kept] = idx[i];
+                ++kept;
+            }
+            mont.erase(mont.begin() + kept, mont.end());
+            d.resize(kept);
+            r.resize(kept);
+            idx.resize(kept);
+        }
+    };
+
+    inline int bitLength(uint64_t x) { return x ? 64 - __builtin_clzll(x) : 0; }
+
+    // --- n < 2^32: fallback escalar ---
+    inline void round32Scalar(const Lanes32 &L, uint32_t a, uint8_t *pass) {
+        for (size_t i = 0; i < L.count; ++i) {
+            const uint32_t n = L.n[i], nInv = L.nInv[i], one = L.one[i];
+            const uint32_t minusOne = n - one;
+            auto mul = [&](uint32_t x, uint32_t y) {
+                return Montgomery32::redc(static_cast<uint64_t>(x) * y, n, nInv);
+            };
+            const uint32_t base = mul(a, L.r2[i]);
+            uint32_t x = one;
+            for (int b = bitLength(L.d[i]) - 1; b >= 0; --b) {
+                x = mul(x, x);
+                if ((L.d[i] >> b) & 1)
+                    x = a == 2 ? (x >= n - x ? x - (n - x) : x + x) : mul(x, base);
+            }
+            bool ok = x == one || x == minusOne;
+            for (uint32_t s = 1; s < L.r[i] && !ok; ++s) {
+                x = mul(x, x);
+                ok = x == minusOne;
+            }
+            pass[i] = ok;
+        }
+    }
+
+#ifdef THERMO_X86_SIMD
+    // --- n < 2^32: AVX2, 4 lanes ---
+    __attribute__((target("avx2")))
+    static inline __m256i load32x4(const std::vector<uint32_t> &v, size_t i) {
+        return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(v.data() + i)));
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i montMulAvx2(__m256i x, __m256i y, __m256i n, __m256i nInv) {
+        const __m256i t = _mm256_mul_epu32(x, y);
+        const __m256i m = _mm256_mul_epu32(t, nInv);
+        const __m256i mn = _mm256_mul_epu32(m, n);
+        const __m256i tHi = _mm256_srli_epi64(t, 32);
+        const __m256i mnHi = _mm256_srli_epi64(mn, 32);
+        const __m256i borrow = _mm256_cmpgt_epi64(mnHi, tHi);
+        return _mm256_add_epi64(_mm256_sub_epi64(tHi, mnHi), _mm256_and_si256(borrow, n));
+    }
+
+    __attribute__((target("avx2")))
+    static void round32Avx2(const Lanes32 &L, uint32_t a, uint8_t *pass) {
+        for (size_t i = 0; i < L.count; i += 4) {
+            const __m256i n = load32x4(L.n, i), nInv = load32x4(L.nInv, i);
+            const __m256i one = load32x4(L.one, i), d = load32x4(L.d, i);
+            const __m256i r = load32x4(L.r, i);
+            const __m256i minusOne = _mm256_sub_epi64(n, one);
+            const __m256i base = montMulAvx2(_mm256_set1_epi64x(a), load32x4(L.r2, i), n, nInv);
+
+            uint32_t maxD = 0, maxR = 0;
+            for (size_t j = i; j < i + 4; ++j) {
+                maxD |= L.d[j];
+                maxR = std::max(maxR, L.r[j]);
+            }
+
+            __m256i x = one;
+            for (int b = bitLength(maxD) - 1; b >= 0; --b) {
+                x = montMulAvx2(x, x, n, nInv);
+                __m256i xa;
+                if (a == 2) {
+                    // x·2 - n se x·2 ≥ n (valores < 2^33, comparação com sinal serve)
+                    const __m256i twice = _mm256_add_epi64(x, x);
+                    const __m256i over = _mm256_cmpgt_epi64(twice, _mm256_sub_epi64(n, _mm256_set1_epi64x(1)));
+                    xa = _mm256_sub_epi64(twice, _mm256_and_si256(over, n));
+                } else {
+                    xa = montMulAvx2(x, base, n, nInv);
+                }
+                const __m256i bit = _mm256_set1_epi64x(int64_t(1) << b);
+                const __m256i take = _mm256_cmpeq_epi64(_mm256_and_si256(d, bit), bit);
+                x = _mm256_blendv_epi8(x, xa, take);
+            }
+
+            __m256i ok = _mm256_or_si256(_mm256_cmpeq_epi64(x, one), _mm256_cmpeq_epi64(x, minusOne));
+            for (uint32_t s = 1; s < maxR && _mm256_movemask_pd(_mm256_castsi256_pd(ok)) != 0xF; ++s) {
+                x = montMulAvx2(x, x, n, nInv);
+                const __m256i active = _mm256_cmpgt_epi64(r, _mm256_set1_epi64x(s));
+                ok = _mm256_or_si256(ok, _mm256_and_si256(active, _mm256_cmpeq_epi64(x, minusOne)));
+            }
+
+            const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(ok));
+            for (size_t j = 0; j < 4 && i + j < L.count; ++j)
+                pass[i + j] = (mask >> j) & 1;
+        }
+    }
+
+    // --- n < 2^32: AVX-512, 8 lanes ---
+    __attribute__((target("avx512f")))
+    static inline __m512i load32x8(const std::vector<uint32_t> &v, size_t i) {
+        return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(v.data() + i)));
+    }
+
+    __attribute__((target("avx512f")))
+    static inline __m512i montMulAvx512(__m512i x, __m512i y, __m512i n, __m512i nInv) {
+        const __m512i t = _mm512_mul_epu32(x, y);
+        const __m512i m = _mm512_mul_epu32(t, nInv);
+        const __m512i mn = _mm512_mul_epu32(m, n);
+        const __m512i tHi = _mm512_srli_epi64(t, 32);
+        const __m512i mnHi = _mm512_srli_epi64(mn, 32);
+        const __m512i diff = _mm512_sub_epi64(tHi, mnHi);
+        return _mm512_mask_add_epi64(diff, _mm512_cmpgt_epu64_mask(mnHi, tHi), diff, n);
+    }
+
+    __attribute__((target("avx512f")))
+    static void round32Avx512(const Lanes32 &L, uint32_t a, uint8_t *pass) {
+        for (size_t i = 0; i < L.count; i += 8) {
+            const __m512i n = load32x8(L.n, i), nInv = load32x8(L.nInv, i);
+            const __m512i one = load32x8(L.one, i), d = load32x8(L.d, i);
+            const __m512i r = load32x8(L.r, i);
+            const __m512i minusOne = _mm512_sub_epi64(n, one);
+            const __m512i base = montMulAvx512(_mm512_set1_epi64(a), load32x8(L.r2, i), n, nInv);
+
+            uint32_t maxD = 0, maxR = 0;
+            for (size_t j = i; j < i + 8; ++j) {
+                maxD |= L.d[j];
+                maxR = std::max(maxR, L.r[j]);
+            }
+
+            __m512i x = one;
+            for (int b = bitLength(maxD) - 1; b >= 0; --b) {
+                x = montMulAvx512(x, x, n, nInv);
+                __m512i xa;
+                if (a == 2) {
+                    const __m512i twice = _mm512_add_epi64(x, x);
+                    xa = _mm512_mask_sub_epi64(twice, _mm512_cmpge_epu64_mask(twice, n), twice, n);
+                } else {
+                    xa = montMulAvx512(x, base, n, nInv);
+                }
+                const __mmask8 take = _mm512_test_epi64_mask(d, _mm512_set1_epi64(int64_t(1) << b));
+                x = _mm512_mask_blend_epi64(take, x, xa);
+            }
+
+            __mmask8 ok = _mm512_cmpeq_epi64_mask(x, one) | _mm512_cmpeq_epi64_mask(x, minusOne);
+            for (uint32_t s = 1; s < maxR && ok != 0xFF; ++s) {
+                x = montMulAvx512(x, x, n, nInv);
+                const __mmask8 active = _mm512_cmpgt_epu64_mask(r, _mm512_set1_epi64(s));
+                ok |= active & _mm512_cmpeq_epi64_mask(x, minusOne);
+            }
+
+            for (size_t j = 0; j < 8 && i + j < L.count; ++j)
+                pass[i + j] = (ok >> j) & 1;
+        }
+    }
+#endif
+
+    using Round32 = void (*)(const Lanes32 &, uint32_t, uint8_t *);
+
+    inline Round32 selectRound32() {
+#ifdef THERMO_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return round32Avx512;
+        if (__builtin_cpu_supports("avx2")) return round32Avx2;
+#endif
+        return round32Scalar;
+    }
+
+    // Nome do kernel que selectRound32() escolhe (para relatórios)
+    inline const char *round32Name() {
+#ifdef THERMO_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return "avx512";
+        if (__builtin_cpu_supports("avx2")) return "avx2";
+#endif
+        return "scalar";
+    }
+
+    // --- n ≥ 2^32: 4 lanes escalares intercaladas ---
+    inline void round64(const Lanes64 &L, uint32_t a, uint8_t *pass) {
+        constexpr size_t LANES = 4;
+        const size_t count = L.size();
+        for (size_t i = 0; i < count; i += LANES) {
+            uint64_t n[LANES], nInv[LANES], one[LANES], minusOne[LANES];
+            uint64_t d[LANES], base[LANES], x[LANES];
+            int r[LANES];
+            uint64_t maxD = 0;
+            int maxR = 0;
+            for (size_t j = 0; j < LANES; ++j) {
+                const size_t k = std::min(i + j, count - 1);  // repete a última lane
+                const Montgomery64 &mont = L.mont[k];
+                n[j] = mont.n; nInv[j] = mont.nInv;
+                one[j] = mont.one; minusOne[j] = mont.minusOne;
+                d[j] = L.d[k]; r[j] = L.r[k];
+                base[j] = mont.toMontgomery(a);
+                x[j] = one[j];
+                maxD |= d[j];
+                maxR = std::max(maxR, r[j]);
+            }
+
+            for (int b = bitLength(maxD) - 1; b >= 0; --b) {
+#pragma GCC unroll 4
+                for (size_t j = 0; j < LANES; ++j) {
+                    const uint64_t sq = Montgomery64::redc(static_cast<__uint128_t>(x[j]) * x[j], n[j], nInv[j]);
+                    // Base 2 (a primeira de todo conjunto): x·2 é uma soma modular
+                    const uint64_t sa = a == 2
+                        ? (sq >= n[j] - sq ? sq - (n[j] - sq) : sq + sq)
+                        : Montgomery64::redc(static_cast<__uint128_t>(sq) * base[j], n[j], nInv[j]);
+                    x[j] = ((d[j] >> b) & 1) ? sa : sq;
+                }
+            }
+
+            bool ok[LANES];
+            for (size_t j = 0; j < LANES; ++j)
+                ok[j] = x[j] == one[j] || x[j] == minusOne[j];
+            for (int s = 1; s < maxR && !(ok[0] && ok[1] && ok[2] && ok[3]); ++s) {
+#pragma GCC unroll 4
+                for (size_t j = 0; j < LANES; ++j) {
+                    x[j] = Montgomery64::redc(static_cast<__uint128_t>(x[j]) * x[j], n[j], nInv[j]);
+                    ok[j] = ok[j] || (s < r[j] && x[j] == minusOne[j]);
+                }
+            }
+
+            for (size_t j = 0; j < LANES && i + j < count; ++j)
+                pass[i + j] = ok[j];
+        }
+    }
+}
+
+inline void MillerRabin::isPrimeBatch(const uint64_t *n, size_t count, uint8_t *out) {
+    using namespace MillerRabinBatch;
+
+    Lanes32 small;
+    Lanes64 large[Witnesses::GROUPS_64];
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t v = n[i];
+        if (v < 121 || v % 2 == 0 || v % 3 == 0 || v % 5 == 0 || v % 7 == 0) {
+            out[i] = isPrime(v);
+            continue;
+        }
+        out[i] = 1;
+        if (v <= UINT32_MAX)
+            small.push(static_cast<uint32_t>(v), i);
+        else
+            large[Witnesses::group64(v)].push(v, i);
+    }
+
+    static const Round32 round32 = selectRound32();
+    std::vector<uint8_t> pass;
+
+    small.pad();
+    for (uint32_t a : Witnesses::BELOW_2_32) {
+        if (small.count == 0) break;
+        pass.resize(small.count);
+        round32(small, a, pass.data());
+        small.keep(pass.data(), out);
+    }
+
+    for (int g = 0; g < Witnesses::GROUPS_64; ++g) {
+        const Witnesses::Set w = Witnesses::set64(g);
+        for (int k = 0; k < w.count && large[g].size() > 0; ++k) {
+            pass.resize(large[g].size());
+            round64(large[g], w.bases[k], pass.data());
+            large[g].keep(pass.data(), out);
+        }
+    }
+}
+
+// ======================= 128 BITS =======================
+
+// Decimal de v (QString e iostream não conhecem __uint128_t)
+inline std::string toDecimal(uint128_t v)
+{
+    std::string s;
+    do {
+        s.push_back(static_cast<char>('0' + static_cast<int>(v % 10)));
+        v /= 10;
+    } while (v != 0);
+    return std::string(s.rbegin(), s.rend());
+}
+
+// Lê "123456" ou "mEk" (mantissa e expoente inteiros, ex. 1e20 ou 25e18);
+// false se não for um inteiro ou não couber em 128 bits
+inline bool parseDecimal(const std::string &text, uint128_t &out)
+{
+    const size_t e = text.find_first_of("eE");
+    auto digits = [](const std::string &s, uint128_t &v) {
+        if (s.empty()) return false;
+        v = 0;
+        for (char c : s) {
+            if (c < '0' || c > '9' || v > (MAX_UINT128 - (c - '0')) / 10) return false;
+            v = v * 10 + (c - '0');
+        }
+        return true;
+    };
+    uint128_t mantissa, exponent = 0;
+    if (!digits(text.substr(0, e), mantissa)) return false;
+    if (e != std::string::npos && !digits(text.substr(e + 1), exponent)) return false;
+    for (uint128_t k = 0; k < exponent; ++k) {
+        if (mantissa > MAX_UINT128 / 10) return false;
+        mantissa *= 10;
+    }
+    out = mantissa;
+    return true;
+}
+
+// Produto 128×128 → 256 bits em (hi, lo), por quatro produtos de 64 bits
+inline void mulWide(uint128_t a, uint128_t b, uint128_t &hi, uint128_t &lo)
+{
+    const uint64_t a0 = static_cast<uint64_t>(a), a1 = static_cast<uint64_t>(a >> 64);
+    const uint64_t b0 = static_cast<uint64_t>(b), b1 = static_cast<uint64_t>(b >> 64);
+    const uint128_t p00 = uint128_t(a0) * b0, p01 = uint128_t(a0) * b1;
+    const uint128_t p10 = uint128_t(a1) * b0, p11 = uint128_t(a1) * b1;
+    const uint128_t mid = (p00 >> 64) + static_cast<uint64_t>(p01) + static_cast<uint64_t>(p10);
+    lo = (mid << 64) | static_cast<uint64_t>(p00);
+    hi = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+}
+
+// ⌊√n⌋ para n de 128 bits
+inline uint64_t isqrtWide(uint128_t n)
+{
+    const long double root = std::sqrt(static_cast<long double>(n));
+    uint64_t r = root >= 18446744073709551615.0L ? UINT64_MAX : static_cast<uint64_t>(root);
+    while (uint128_t(r) * r > n) --r;
+    while (r < UINT64_MAX && uint128_t(r + 1) * (r + 1) <= n) ++r;
+    return r;
+}
+
+// Montgomery com duas palavras (R = 2¹²⁸), mesma interface de Montgomery<U, W>.
+// Não há tipo nativo de 256 bits: o produto sai de mulWide e o REDC só
+// precisa da metade alta de t e de m·n.
+struct Montgomery128 {
+    uint128_t n;
+    uint128_t nInv;     // n⁻¹ mod R
+    uint128_t r2;       // R² mod n
+    uint128_t one;      // R mod n
+    uint128_t minusOne; // n - one
+
+    explicit Montgomery128(uint128_t modulus) : n(modulus) {
+        nInv = n;
+        for (int bits = 3; bits < 128; bits *= 2)
+            nInv *= uint128_t(2) - n * nInv;
+        one = (uint128_t(0) - n) % n;
+        // R² = R·2¹²⁸: 128 dobras modulares de R, uma vez por n
+        r2 = one;
+        for (int i = 0; i < 128; ++i)
+            r2 = add(r2, r2);
+        minusOne = n - one;
+    }
+
+    uint128_t mul(uint128_t a, uint128_t b) const {
+        uint128_t tHi, tLo, mnHi, mnLo;
+        mulWide(a, b, tHi, tLo);
+        mulWide(tLo * nInv, n, mnHi, mnLo);
+        return tHi >= mnHi ? tHi - mnHi : tHi - mnHi + n;
+    }
+
+    uint128_t add(uint128_t a, uint128_t b) const { return a >= n - b ? a - (n - b) : a + b; }
+    uint128_t sub(uint128_t a, uint128_t b) const { return a >= b ? a - b : a - b + n; }
+    // a/2 mod n (n ímpar): (a + n)/2 sem estourar os 128 bits
+    uint128_t half(uint128_t a) const { return (a & 1) ? (a >> 1) + (n >> 1) + 1 : a >> 1; }
+
+    uint128_t toMontgomery(uint128_t a) const { return mul(a % n, r2); }
+
+    // Inteiro pequeno com sinal na forma de Montgomery
+    uint128_t fromSigned(int64_t v) const {
+        const uint128_t m = toMontgomery(static_cast<uint128_t>(v < 0 ? -v : v));
+        return v < 0 && m != 0 ? n - m : m;
+    }
+
+    uint128_t pow(uint128_t base, uint128_t exp) const {
+        uint128_t result = one;
+        while (exp > 0) {
+            if (exp & 1)
+                result = mul(result, base);
+            exp >>= 1;
+            base = mul(base, base);
+        }
+        return result;
+    }
+};
+
+// Baillie-PSW para n de 128 bits: Miller-Rabin forte na base 2 seguido do
+// teste forte de Lucas com os parâmetros de Selfridge (P = 1, Q = (1 − D)/4).
+// Não há contraexemplo conhecido; abaixo de 2⁶⁴ o teste delega ao
+// MillerRabin, que é determinístico.
+class BailliePSW {
+public:
+    static bool isPrime(uint128_t n) {
+        if (n <= UINT64_MAX) return MillerRabin::isPrime(static_cast<uint64_t>(n));
+        if ((n & 1) == 0) return false;
+
+        // Uma divisão de 128 bits; os primos pequenos saem do resto de 64
+        constexpr uint64_t SMALL_PRODUCT = 614889782588491410ULL;   // 3·5·7·…·47
+        const uint64_t r = static_cast<uint64_t>(n % SMALL_PRODUCT);
+        for (uint64_t q : {3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47})
+            if (r % q == 0) return false;
+
+        const Montgomery128 mont(n);
+        if (!strongBase2(mont)) return false;
+        // Quadrados não têm D com (D/n) = −1; a busca de Selfridge não pararia
+        const uint64_t root = isqrtWide(n);
+        if (uint128_t(root) * root == n) return false;
+        return strongLucas(mont);
+    }
+
+    // Símbolo de Jacobi (a/n), n ímpar
+    static int jacobi(int64_t a, uint128_t n) {
+        uint128_t x = static_cast<uint128_t>(a < 0 ? -a : a) % n;
+        int result = (a < 0 && n % 4 == 3) ? -1 : 1;   // (−1/n)
+        while (x != 0) {
+            while ((x & 1) == 0) {
+                x >>= 1;
+                const unsigned r = static_cast<unsigned>(n % 8);
+                if (r == 3 || r == 5) result = -result;
+            }
+            std::swap(x, n);
+            if (x % 4 == 3 && n % 4 == 3) result = -result;
+            x %= n;
+        }
+        return n == 1 ? result : 0;
+    }
+
+private:
+    static bool strongBase2(const Montgomery128 &mont) {
+        uint128_t d = mont.n - 1;
+        int r = 0;
+        while ((d & 1) == 0) {
+            d >>= 1;
+            ++r;
+        }
+        uint128_t x = mont.pow(mont.add(mont.one, mont.one), d);
+        if (x == mont.one || x == mont.minusOne) return true;
+        for (int i = 0; i < r - 1; ++i) {
+            x = mont.mul(x, x);
+            if (x == mont.minusOne) return true;
+        }
+        return false;
+    }
+
+    // n + 1 = d·2^s; n é primo provável se U_d ≡ 0 ou V_{d·2^k} ≡ 0 para
+    // algum k < s. Dobra: U₂ₖ = UₖVₖ, V₂ₖ = Vₖ² − 2Qᵏ; passo: Uₖ₊₁ = (Uₖ + Vₖ)/2,
+    // Vₖ₊₁ = (D·Uₖ + Vₖ)/2.
+    static bool strongLucas(const Montgomery128 &mont) {
+        const uint128_t n = mont.n;
+        int64_t D = 5;
+        for (;; D = D > 0 ? -(D + 2) : -D + 2) {
+            const int j = jacobi(D, n);
+            if (j == -1) break;
+            if (j == 0 && static_cast<uint128_t>(D < 0 ? -D : D) != n) return false;
+        }
+        const uint128_t mD = mont.fromSigned(D);
+        const uint128_t mQ = mont.fromSigned((1 - D) / 4);
+
+        uint128_t d = n + 1;   // n ímpar > 2⁶⁴ e n ≢ 0 mod 3: não é 2¹²⁸ − 1
+        int s = 0;
+        while ((d & 1) == 0) {
+            d >>= 1;
+            ++s;
+        }
+
+        uint128_t U = mont.one, V = mont.one, Qk = mQ;
+        int top = 127;
+        while (!((d >> top) & 1)) --top;
+        for (int bit = top - 1; bit >= 0; --bit) {
+            U = mont.mul(U, V);
+            V = mont.sub(mont.mul(V, V), mont.add(Qk, Qk));
+            Qk = mont.mul(Qk, Qk);
+            if ((d >> bit) & 1) {
+                const uint128_t u = mont.half(mont.add(U, V));
+                V = mont.half(mont.add(mont.mul(mD, U), V));
+                U = u;
+                Qk = mont.mul(Qk, mQ);
+            }
+        }
+        if (U == 0 || V == 0) return true;
+        for (int k = 1; k < s; ++k) {
+            V = mont.sub(mont.mul(V, V), mont.add(Qk, Qk));
+            if (V == 0) return true;
+            Qk = mont.mul(Qk, Qk);
+        }
+        return false;
+    }
+};
+
+// ======================= CRIVO SEGMENTADO (WHEEL MOD 210) =======================
+
+// Layout do bitmap: cada ciclo de 210 números ocupa 48 bits consecutivos,
+// um por resíduo coprimo (mesma ordem de WHEEL_OFFSETS). O bit do ciclo c e
+// índice k representa n = 210c + WHEEL_OFFSETS[k]. Bit 1 = primo.
+//
+// Para um primo de crivo p = 210a + r_i e um multiplicador k = 210c + r_k
+// (k coprimo com 210, logo p·k também é):
+//   ciclo(p·k) = c·p + a·r_k + ⌊r_i·r_k / 210⌋,   resíduo = r_i·r_k mod 210
+// Avançar k para o próximo resíduo da wheel soma a·gap[k] + carry[i][k] ao
+// ciclo, sem nenhuma divisão no laço interno.
+namespace WheelTables {
+    constexpr int MOD = 210;
+
+    struct Tables {
+        uint8_t residueIndex[MOD] = {};   // índice 0..47, ou 0xFF se não coprimo
+        uint8_t nextIndex[MOD] = {};      // primeiro k com offset >= r (48 = próximo ciclo)
+        uint8_t gap[48] = {};             // offset[k+1] - offset[k], com offset[48] = 211
+        uint8_t bit[48][48] = {};         // índice do resíduo de r_i·r_k mod 210
+        uint8_t carry[48][48] = {};       // Δ⌊r_i·r_k / 210⌋ ao passar de k para k+1
+        // Volta completa da wheel (k = 0..47) a partir do múltiplo com k = 0:
+        // bit relativo = a·turnA[k] + turnB[i][k]
+        uint16_t turnA[48] = {};          // 48·(r_k - 1)
+        uint16_t turnB[48][48] = {};      // 48·⌊r_i·r_k / 210⌋ + bit[i][k]
+        // Twins no bitmap: k com gap[k] = 2 começa um par (15 por ciclo,
+        // incluindo 209 → 211 do ciclo seguinte). Um trecho alinhado a 4
+        // ciclos (192 bits) repete a máscara a cada 3 palavras.
+        uint64_t twinStarts[3] = {};
+        int8_t twinClass[48] = {};        // classIndex do p que começa o par, ou -1
+    };
+
+    constexpr Tables build() {
+        Tables t{};
+        for (int r = 0; r < MOD; ++r) t.residueIndex[r] = 0xFF;
+        for (int k = 0; k < Constants::WHEEL_SIZE; ++k)
+            t.residueIndex[Constants::WHEEL_OFFSETS[k]] = static_cast<uint8_t>(k);
+        for (int r = 0, k = 0; r < MOD; ++r) {
+            while (k < Constants::WHEEL_SIZE && Constants::WHEEL_OFFSETS[k] < r) ++k;
+            t.nextIndex[r] = static_cast<uint8_t>(k);
+        }
+        for (int k = 0; k < Constants::WHEEL_SIZE; ++k) {
+            int next = (k + 1 < Constants::WHEEL_SIZE) ? Constants::WHEEL_OFFSETS[k + 1] : MOD + 1;
+            t.gap[k] = static_cast<uint8_t>(next - Constants::WHEEL_OFFSETS[k]);
+        }
+        for (int i = 0; i < Constants::WHEEL_SIZE; ++i) {
+            int ri = Constants::WHEEL_OFFSETS[i];
+            for (int k = 0; k < Constants::WHEEL_SIZE; ++k) {
+                int rk = Constants::WHEEL_OFFSETS[k];
+                // ⌊r_i·211 / 210⌋ = r_i: o "k = 48" é o resíduo 1 do ciclo seguinte
+                int qNext = (k + 1 < Constants::WHEEL_SIZE)
+                    ? ri * Constants::WHEEL_OFFSETS[k + 1] / MOD : ri;
+                t.bit[i][k] = t.residueIndex[ri * rk % MOD];
+                t.carry[i][k] = static_cast<uint8_t>(qNext - ri * rk / MOD);
+                t.turnB[i][k] = static_cast<uint16_t>(48 * (ri * rk / MOD) + t.bit[i][k]);
+            }
+            t.turnA[i] = static_cast<uint16_t>(48 * (Constants::WHEEL_OFFSETS[i] - 1));
+        }
+        for (int k = 0; k < Constants::WHEEL_SIZE; ++k) {
+            const int r30 = Constants::WHEEL_OFFSETS[k] % 30;
+            t.twinClass[k] = static_cast<int8_t>(t.gap[k] != 2 ? -1
+                             : r30 == 11 ? 0 : r30 == 17 ? 1 : 2);
+        }
+        for (int pos = 0; pos < 192; ++pos)
+            if (t.gap[pos % 48] == 2)
+                t.twinStarts[pos / 64] |= uint64_t(1) << (pos % 64);
+        return t;
+    }
+
+    constexpr Tables T = build();
+}
+
+// Cache persistente dos bitmaps do PrimeSieve, por segmento da grade global
+// (segmento s = ciclos [s·SEGMENT_CYCLES, (s+1)·SEGMENT_CYCLES)). Um único
+// arquivo mapeado em memória com capacidade fixa de slots:
+//
+//   cabeçalho (4 KiB) | entradas (key, lastUse, checksum) | slots de 256 KiB
+//
+// key = s + 1 (0 = slot livre). Quando o orçamento enche, o slot usado há
+// mais tempo (lastUse, relógio persistido no cabeçalho) é reaproveitado.
+// O checksum de cada slot é conferido na leitura: um slot gravado pela metade
+// (crash) vira miss e é crivado de novo. Seguro entre threads (um mutex; a
+// cópia de um slot leva microssegundos, contra milissegundos do crivo); entre
+// processos, o arquivo fica sob flock exclusivo enquanto aberto.
+class SegmentCache {
+public:
+    struct Counters {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    SegmentCache() = default;
+    SegmentCache(const SegmentCache &) = delete;
+    SegmentCache &operator=(const SegmentCache &) = delete;
+    ~SegmentCache() { close(); }
+
+    // Abre (ou cria) o cache em path com até budgetBytes de slots de
+    // segmentBytes cada. Falha se outro processo já estiver com ele aberto.
+    // Com outro orçamento, os segmentos usados mais recentemente que cabem
+    // no novo passam para um arquivo redimensionado (previousCapacity() diz
+    // de quantos slots veio); um arquivo de outro formato ou tamanho de
+    // segmento é recriado vazio.
+    bool open(const std::string &path, uint64_t budgetBytes, size_t segmentBytes,
+              std::string *error = nullptr)
+    {
+        close();
+        m_segmentBytes = segmentBytes;
+        m_stride = (segmentBytes + PAGE - 1) / PAGE * PAGE;
+        m_capacity = std::max<uint64_t>(1, budgetBytes / m_stride);
+        m_slotsOffset = slotsOffset(m_capacity);
+        m_size = m_slotsOffset + m_capacity * m_stride;
+        m_previousCapacity = 0;
+
+        int fd = openLocked(path, O_RDWR | O_CREAT, error);
+        if (fd < 0) return false;
+        struct stat st;
+        bool fresh = ::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) != m_size;
+        if (fresh && st.st_size > 0 && !resize(path, fd, static_cast<uint64_t>(st.st_size), error)) {
+            ::close(fd);
+            return false;
+        }
+        if (m_previousCapacity != 0) fresh = false;
+        // Arquivo esparso: só os slots preenchidos ocupam disco
+        if (fresh && (::ftruncate(fd, 0) != 0 || ::ftruncate(fd, static_cast<off_t>(m_size)) != 0)) {
+            ::close(fd);
+            return fail(error, "não foi possível dimensionar " + path);
+        }
+        void *map = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            return fail(error, "não foi possível mapear " + path);
+        }
+        m_fd = fd;   // o flock vale até close()
+        m_data = static_cast<uint8_t *>(map);
+
+        Header *h = header();
+        if (!fresh && (h->magic != MAGIC || h->version != VERSION
+                       || h->segmentBytes != segmentBytes || h->capacity != m_capacity))
+            fresh = true;
+        if (fresh) {
+            std::memset(m_data, 0, m_slotsOffset);
+            *h = Header{MAGIC, VERSION, segmentBytes, m_capacity, 0};
+        }
+        for (uint64_t i = 0; i < m_capacity; ++i)
+            if (entries()[i].key != 0) m_index[entries()[i].key - 1] = i;
+        return true;
+    }
+
+    bool isOpen() const { return m_data != nullptr; }
+
+    void close()
+    {
+        if (!m_data) return;
+        ::msync(m_data, m_size, MS_ASYNC);
+        ::munmap(m_data, m_size);
+        ::close(m_fd);
+        m_data = nullptr;
+        m_fd = -1;
+        m_index.clear();
+    }
+
+    // Copia o bitmap do segmento para words; false (miss) se não houver
+    bool load(uint64_t segment, uint64_t *words)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(segment);
+        if (it == m_index.end()) {
+            ++m_counters.misses;
+            return false;
+        }
+        Entry &e = entries()[it->second];
+        const uint8_t *slot = m_data + m_slotsOffset + it->second * m_stride;
+        std::memcpy(words, slot, m_segmentBytes);
+        if (checksum(words) != e.checksum) {
+            e.key = 0;
+            m_index.erase(it);
+            ++m_counters.misses;
+            return false;
+        }
+        e.lastUse = ++header()->clock;
+        ++m_counters.hits;
+        return true;
+    }
+
+    // Guarda o bitmap do segmento, despejando o slot menos usado se preciso
+    void store(uint64_t segment, const uint64_t *words)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_index.count(segment)) return;
+        uint64_t slot = 0;
+        if (m_index.size() < m_capacity) {
+            while (entries()[slot].key != 0) ++slot;
+        } else {
+            for (uint64_t i = 1; i < m_capacity; ++i)
+                if (entries()[i].lastUse < entries()[slot].lastUse) slot = i;
+            m_index.erase(entries()[slot].key - 1);
+            ++m_counters.evictions;
+        }
+        // Dados antes da chave: a entrada só passa a valer com o slot completo
+        Entry &e = entries()[slot];
+        e.key = 0;
+        std::memcpy(m_data + m_slotsOffset + slot * m_stride, words, m_segmentBytes);
+        e.checksum = checksum(words);
+        e.lastUse = ++header()->clock;
+        e.key = segment + 1;
+        m_index[segment] = slot;
+    }
+
+    Counters counters() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_counters;
+    }
+
+    uint64_t capacity() const { return m_capacity; }
+
+    // Capacidade do arquivo antes de um redimensionamento no último open(),
+    // ou 0; os segmentos que não couberam contam como evictions
+    uint64_t previousCapacity() const { return m_previousCapacity; }
+
+    // Segmentos presentes no cache
+    uint64_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_index.size();
+    }
+
+private:
+    static constexpr uint64_t MAGIC = 0x31435343524D4854ULL;   // "THMRCSC1"
+    static constexpr uint64_t VERSION = 1;
+    static constexpr uint64_t PAGE = 4096;
+
+    struct Header {
+        uint64_t magic;
+        uint64_t version;
+        uint64_t segmentBytes;
+        uint64_t capacity;
+        uint64_t clock;
+    };
+
+    struct Entry {
+        uint64_t key;
+        uint64_t lastUse;
+        uint64_t checksum;
+    };
+
+    Header *header() { return reinterpret_cast<Header *>(m_data); }
+    Entry *entries() { return reinterpret_cast<Entry *>(m_data + PAGE); }
+
+    static uint64_t slotsOffset(uint64_t capacity)
+    {
+        return PAGE + (capacity * sizeof(Entry) + PAGE - 1) / PAGE * PAGE;
+    }
+
+    // Abre path com flock exclusivo sem esperar; -1 se outro processo o tem
+    int openLocked(const std::string &path, int flags, std::string *error)
+    {
+        const int fd = ::open(path.c_str(), flags, 0644);
+        if (fd < 0) {
+            fail(error, "não foi possível abrir " + path);
+            return -1;
+        }
+        if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            ::close(fd);
+            fail(error, errno == EWOULDBLOCK ? "cache de segmentos em uso por outro processo: " + path
+                                             : "não foi possível travar " + path);
+            return -1;
+        }
+        // Trocado por um redimensionamento entre o open e o flock: o
+        // arquivo travado já não é o do caminho
+        struct stat held, current;
+        if (::fstat(fd, &held) != 0 || ::stat(path.c_str(), &current) != 0
+            || held.st_ino != current.st_ino || held.st_dev != current.st_dev) {
+            ::close(fd);
+            fail(error, "cache de segmentos em uso por outro processo: " + path);
+            return -1;
+        }
+        return fd;
+    }
+
+    // O arquivo travado em fd (oldSize bytes) tem outra capacidade: copia os
+    // m_capacity segmentos de lastUse mais recente, com checksum válido, para
+    // path + ".resize" (travado), que substitui path por rename; fd passa a
+    // ser o novo arquivo. Sem efeito (e true) se fd não é um cache compatível.
+    bool resize(const std::string &path, int &fd, uint64_t oldSize, std::string *error)
+    {
+        if (oldSize < PAGE) return true;
+        void *oldMap = ::mmap(nullptr, oldSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (oldMap == MAP_FAILED) return true;
+        const uint8_t *old = static_cast<const uint8_t *>(oldMap);
+        const Header oldHeader = *reinterpret_cast<const Header *>(old);
+        const uint64_t oldCapacity = oldHeader.capacity;
+        if (oldHeader.magic != MAGIC || oldHeader.version != VERSION
+            || oldHeader.segmentBytes != m_segmentBytes || oldCapacity == 0
+            || oldCapacity > (oldSize - PAGE) / m_stride
+            || slotsOffset(oldCapacity) + oldCapacity * m_stride != oldSize) {
+            ::munmap(oldMap, oldSize);
+            return true;
+        }
+        const uint64_t oldSlots = slotsOffset(oldCapacity);
+        const Entry *oldEntries = reinterpret_cast<const Entry *>(old + PAGE);
+
+        std::vector<uint64_t> live;
+        for (uint64_t i = 0; i < oldCapacity; ++i)
+            if (oldEntries[i].key != 0) live.push_back(i);
+        std::sort(live.begin(), live.end(), [&](uint64_t a, uint64_t b) {
+            return oldEntries[a].lastUse > oldEntries[b].lastUse;
+        });
+
+        const std::string tmp = path + ".resize";
+        const int newFd = openLocked(tmp, O_RDWR | O_CREAT | O_TRUNC, error);
+        void *newMap = MAP_FAILED;
+        if (newFd >= 0 && ::ftruncate(newFd, static_cast<off_t>(m_size)) == 0)
+            newMap = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, newFd, 0);
+        if (newMap == MAP_FAILED) {
+            ::munmap(oldMap, oldSize);
+            if (newFd >= 0) {
+                ::close(newFd);
+                ::unlink(tmp.c_str());
+                fail(error, "não foi possível redimensionar " + path);
+            }
+            return false;
+        }
+
+        uint8_t *data = static_cast<uint8_t *>(newMap);
+        Entry *entries = reinterpret_cast<Entry *>(data + PAGE);
+        uint64_t kept = 0;
+        for (uint64_t i : live) {
+            if (kept == m_capacity) break;
+            const uint64_t *words = reinterpret_cast<const uint64_t *>(old + oldSlots + i * m_stride);
+            if (checksum(words) != oldEntries[i].checksum) continue;
+            std::memcpy(data + m_slotsOffset + kept * m_stride, words, m_segmentBytes);
+            entries[kept++] = oldEntries[i];
+        }
+        *reinterpret_cast<Header *>(data) = Header{MAGIC, VERSION, m_segmentBytes, m_capacity, oldHeader.clock};
+        m_counters.evictions += live.size() - kept;
+
+        const bool synced = ::msync(data, m_size, MS_SYNC) == 0;
+        ::munmap(newMap, m_size);
+        ::munmap(oldMap, oldSize);
+        if (!synced || ::rename(tmp.c_str(), path.c_str()) != 0) {
+            ::close(newFd);
+            ::unlink(tmp.c_str());
+            return fail(error, "não foi possível redimensionar " + path);
+        }
+        ::close(fd);
+        fd = newFd;
+        m_previousCapacity = oldCapacity;
+        return true;
+    }
+
+    uint64_t checksum(const uint64_t *words) const
+    {
+        uint64_t h = m_segmentBytes;
+        for (size_t i = 0; i < m_segmentBytes / 8; ++i)
+            h = (h ^ words[i]) * 0x9E3779B97F4A7C15ULL;
+        return h;
+    }
+
+    bool fail(std::string *error, const std::string &message)
+    {
+        if (error) *error = message;
+        return false;
+    }
+
+    uint8_t *m_data = nullptr;
+    int m_fd = -1;
+    uint64_t m_size = 0;
+    uint64_t m_segmentBytes = 0;
+    uint64_t m_stride = 0;
+    uint64_t m_capacity = 0;
+    uint64_t m_slotsOffset = 0;
+    uint64_t m_previousCapacity = 0;
+    std::unordered_map<uint64_t, uint64_t> m_index;   // segmento → slot
+    Counters m_counters;
+    mutable std::mutex m_mutex;
+};
+
+// Crivo de Eratóstenes segmentado, bit-packed no layout da wheel mod 210.
+// Enumera em ordem crescente os primos coprimos com 210 (isto é, p >= 11)
+// em [start, limit); 2, 3, 5 e 7 nunca aparecem, como no WheelIterator.
+//  - 11..47 são removidos por padrões pré-crivados (cópia + AND);
+//  - primos de crivo > 47 são gerados sob demanda até √(limite do segmento);
+//    os menores que BUCKET_PRIME riscam todo segmento, os maiores esperam em
+//    buckets, um por segmento futuro, até o segmento do próximo acerto (como
+//    em TupleSieve), e saem de cena quando o próximo acerto passa de limit;
+//  - segmentos de SEGMENT_BYTES cabem no cache L2 e seguem a grade global
+//    de SEGMENT_CYCLES ciclos (o primeiro vai só até a próxima fronteira);
+//  - com setCache(), cada segmento da grade vem do SegmentCache quando já
+//    foi crivado antes, e o que falta é crivado e guardado.
+// Miller-Rabin continua disponível para testes isolados.
+class PrimeSieve {
+public:
+    static constexpr uint64_t SEGMENT_BYTES = 256 * 1024;
+    // Ciclos por segmento: múltiplo de 4 para que cada segmento comece em
+    // fronteira de palavra de 64 bits (4 ciclos = 192 bits = 3 palavras)
+    static constexpr uint64_t SEGMENT_CYCLES = (SEGMENT_BYTES * 8 / 48) / 4 * 4;
+    static constexpr uint64_t SEGMENT_WORDS = SEGMENT_CYCLES * 48 / 64;
+    // Primos de crivo a partir daqui vão para os buckets: acertam em média
+    // 48·SEGMENT_CYCLES/p vezes por segmento, poucas demais para justificar
+    // uma visita a cada segmento
+    static constexpr uint64_t BUCKET_PRIME = 4 * SEGMENT_CYCLES;
+
+    explicit PrimeSieve(uint64_t start = 0, uint64_t limit = UINT64_MAX)
+        : m_words(SEGMENT_WORDS)
+    {
+        presievePatterns();
+        reset(start, limit);
+    }
+
+    // Reposiciona em [start, limit) reaproveitando os primos de crivo até
+    // BASE_PRIME; os maiores voltam a sair de m_source
+    void reset(uint64_t start, uint64_t limit)
+    {
+        m_start = start;
+        m_limit = limit;
+        m_nextCycle = start / (4 * 210) * 4;
+        m_numWords = 0;
+        m_skipped = false;
+
+        // Um primo p avança no máximo 10p/210 + 10 ciclos de um acerto ao
+        // seguinte; o anel cobre essa distância em segmentos
+        const uint64_t maxPrime = std::min<uint64_t>(
+            static_cast<uint64_t>(std::sqrt(static_cast<double>(limit))) + 1, UINT32_MAX);
+        size_t ring = 2;
+        while (ring < (maxPrime / 21 + 10) / SEGMENT_CYCLES + 2)
+            ring *= 2;
+        m_buckets.resize(ring);
+        restartSievingPrimes();
+    }
+
+    // Lê e grava os bitmaps em cache (nullptr desliga); cache precisa viver
+    // mais que o crivo. Os segmentos passam a ser sempre inteiros na grade.
+    void setCache(SegmentCache *cache) { m_cache = cache; }
+
+    // Crivo do próximo segmento; false quando passou de limit
+    bool nextSegment()
+    {
+        const uint64_t lastCycle = (m_limit - 1) / 210;
+        if (m_start >= m_limit || m_nextCycle > lastCycle)
+            return false;
+
+        m_lowCycle = m_nextCycle;
+        const uint64_t gridLow = m_lowCycle / SEGMENT_CYCLES * SEGMENT_CYCLES;
+        const bool cacheable = m_cache && gridLow + SEGMENT_CYCLES <= UINT64_MAX / 210;
+        if (cacheable) {
+            // Segmento inteiro da grade, mesmo nas pontas: o recorte em
+            // [start, limit) fica com clearOutside
+            m_lowCycle = gridLow;
+            m_numCycles = SEGMENT_CYCLES;
+        } else {
+            m_numCycles = std::min(gridLow + SEGMENT_CYCLES - m_lowCycle, lastCycle - m_lowCycle + 1);
+            m_numCycles = (m_numCycles + 3) / 4 * 4;
+        }
+        m_nextCycle = m_lowCycle + m_numCycles;
+
+        const uint64_t numWords = m_numCycles * 48 / 64;
+        const uint64_t segment = m_lowCycle / SEGMENT_CYCLES;
+        if (cacheable && m_cache->load(segment, m_words.data())) {
+            m_skipped = true;
+        } else {
+            // Depois de segmentos vindos do cache os primos de crivo estão
+            // atrasados: reativa todos a partir deste segmento
+            if (m_skipped) {
+                restartSievingPrimes();
+                m_skipped = false;
+            }
+            // Último ciclo que algum segmento ainda crivará: com cache, o
+            // segmento da grade inteiro, porque o bitmap guardado é reusado
+            const uint64_t lastSieved = cacheable
+                ? lastCycle / SEGMENT_CYCLES * SEGMENT_CYCLES + SEGMENT_CYCLES - 1 : lastCycle;
+            copyPresieve(numWords);
+            addSievingPrimes(lastSieved);
+
+            crossOff();
+            crossOffBucket(lastSieved);
+
+            if (m_lowCycle == 0) {
+                m_words[0] &= ~uint64_t(1);     // 1 não é primo
+                m_words[0] |= uint64_t(0xFFE);  // 11..47 (removidos pelo pré-crivo)
+            }
+            if (cacheable) m_cache->store(segment, m_words.data());
+        }
+        clearOutside(numWords);
+        m_numWords = numWords;
+        return true;
+    }
+
+    uint64_t segmentLow() const { return m_lowCycle * 210; }
+    uint64_t segmentHigh() const { return std::min(m_limit, segmentEnd()); }
+    // Posições da wheel no bitmap do segmento (48 por ciclo)
+    uint64_t segmentCandidates() const { return m_numCycles * 48; }
+
+    // Chama f(p) para cada primo do segmento atual, em ordem crescente
+    template <typename F>
+    void forEachPrime(F &&f) const
+    {
+        const uint64_t base = m_lowCycle * 210;
+        for (uint64_t w = 0; w < m_numWords; ++w) {
+            uint64_t bits = m_words[w];
+            while (bits) {
+                uint64_t pos = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                uint64_t cyc = pos / 48;
+                f(base + cyc * 210 + Constants::WHEEL_OFFSETS[pos - cyc * 48]);
+            }
+        }
+    }
+
+    // Acesso direto ao bitmap do segmento atual, para os laços que trabalham
+    // palavra a palavra: o bit pos representa valueAt(pos). O segmento começa
+    // em múltiplo de 4 ciclos, então a wheel se repete a cada 3 palavras.
+    const uint64_t *words() const { return m_words.data(); }
+    uint64_t wordCount() const { return m_numWords; }
+
+    uint64_t valueAt(uint64_t pos) const
+    {
+        const uint64_t cyc = pos / 48;
+        return (m_lowCycle + cyc) * 210 + Constants::WHEEL_OFFSETS[pos - cyc * 48];
+    }
+
+    // Palavra w da máscara de twins: bit pos ligado se pos e a posição
+    // seguinte da wheel são primos e distam 2 (bitmap AND bitmap deslocado de
+    // um bit, restrito às posições de WheelTables::T.twinStarts). O par que
+    // atravessa o fim do segmento não aparece aqui.
+    uint64_t twinWord(uint64_t w) const
+    {
+        const uint64_t bits = m_words[w];
+        const uint64_t next = w + 1 < m_numWords ? m_words[w + 1] : 0;
+        return bits & (bits >> 1 | next << 63) & WheelTables::T.twinStarts[w % 3];
+    }
+
+    // classIndex do twin que começa no bit pos, sem divisão por 30
+    static int twinClassAt(uint64_t pos) { return WheelTables::T.twinClass[pos % 48]; }
+
+    bool isPrimeFromWheel(uint64_t n) const {
+        return MillerRabin::isPrimeFromWheel(n);
+    }
+
+    bool isPrime(uint64_t n) const {
+        return MillerRabin::isPrime(n);
+    }
+
+private:
+    // Estado de um primo de crivo p = 210a + r_cls: próximo múltiplo no ciclo
+    // cycle (relativo ao início do segmento) com multiplicador de índice k
+    struct SievingPrime {
+        uint32_t a;
+        uint32_t cycle;
+        uint8_t cls;
+        uint8_t k;
+    };
+
+    // Primo grande no bucket do segmento da grade do próximo acerto; só o
+    // estado desse acerto, 8 bytes
+    struct BucketEntry {
+        uint32_t a;
+        uint32_t pos;   // (cls << 22) | (k << 16) | ciclo no segmento da grade
+    };
+    static_assert(SEGMENT_CYCLES <= (uint64_t(1) << 16), "ciclo no segmento cabe em 16 bits");
+
+    // Primos de crivo até aqui vêm de um crivo simples e ficam guardados
+    // entre resets (no máximo 2,2 MB); acima, m_source os entrega um segmento
+    // por vez. BASE_PRIME² passa de 2³² + um segmento, então m_source nunca
+    // precisa de um m_source próprio.
+    static constexpr uint64_t BASE_PRIME = uint64_t(1) << 23;
+
+    // Pré-crivo: os primos 11..47 são removidos combinando (AND) padrões
+    // periódicos em vez de riscados um a um. Cada padrão cobre 4× o produto
+    // dos seus primos em ciclos, para que o período caia em fronteira de palavra.
+    static constexpr uint64_t PRESIEVE_LAST = 47;
+
+    struct PresievePattern {
+        uint64_t cycles;
+        std::vector<uint64_t> words;
+    };
+
+    static const std::vector<PresievePattern> &presievePatterns()
+    {
+        static const std::vector<PresievePattern> patterns = [] {
+            const std::vector<std::vector<uint64_t>> groups = {
+                {11, 13, 17}, {19, 23}, {29, 31}, {37, 41}, {43, 47}
+            };
+            std::vector<PresievePattern> out;
+            for (const auto &group : groups) {
+                uint64_t prod = 1;
+                for (uint64_t q : group) prod *= q;
+                PresievePattern pat{4 * prod, std::vector<uint64_t>(4 * prod * 48 / 64, 0)};
+                for (uint64_t c = 0; c < pat.cycles; ++c) {
+                    for (int k = 0; k < Constants::WHEEL_SIZE; ++k) {
+                        uint64_t n = c * 210 + Constants::WHEEL_OFFSETS[k];
+                        bool keep = true;
+                        for (uint64_t q : group) keep = keep && (n % q != 0);
+                        if (keep) {
+                            uint64_t pos = c * 48 + k;
+                            pat.words[pos / 64] |= uint64_t(1) << (pos % 64);
+                        }
+                    }
+                }
+                out.push_back(std::move(pat));
+            }
+            return out;
+        }();
+        return patterns;
+    }
+
+    void copyPresieve(uint64_t numWords)
+    {
+        bool first = true;
+        for (const PresievePattern &pat : presievePatterns()) {
+            const uint64_t patWords = pat.words.size();
+            uint64_t src = (m_lowCycle % pat.cycles) * 48 / 64;
+            for (uint64_t dst = 0; dst < numWords; src = 0) {
+                uint64_t n = std::min(numWords - dst, patWords - src);
+                const uint64_t *from = pat.words.data() + src;
+                uint64_t *to = m_words.data() + dst;
+                if (first) {
+                    std::copy_n(from, n, to);
+                } else {
+                    for (uint64_t i = 0; i < n; ++i) to[i] &= from[i];
+                }
+                dst += n;
+            }
+            first = false;
+        }
+    }
+
+    // Gera primos de crivo até need (no máximo BASE_PRIME) com um crivo
+    // simples em blocos; cada bloco usa os primos já gerados (o primeiro é
+    // autossuficiente)
+    void generateBasePrimes(uint64_t need)
+    {
+        need = std::min(need, BASE_PRIME);
+        while (m_generatedUpTo < need) {
+            const uint64_t lo = m_generatedUpTo + 1;
+            uint64_t hi = std::min(need + (uint64_t(1) << 16), lo + (uint64_t(1) << 20));
+            hi = std::min(hi, BASE_PRIME);
+            if (lo > 2)
+                hi = std::min(hi, m_generatedUpTo * m_generatedUpTo);
+
+            std::vector<uint8_t> composite(hi - lo + 1, 0);
+            if (lo == 2) {
+                for (uint64_t q = 2; q * q <= hi; ++q) {
+                    if (composite[q - lo]) continue;
+                    for (uint64_t m = q * q; m <= hi; m += q) composite[m - lo] = 1;
+                }
+            } else {
+                for (uint32_t q : m_basePrimes) {
+                    uint64_t qq = uint64_t(q) * q;
+                    if (qq > hi) break;
+                    uint64_t m = std::max(qq, (lo + q - 1) / q * q);
+                    for (; m <= hi; m += q) composite[m - lo] = 1;
+                }
+            }
+            for (uint64_t n = lo; n <= hi; ++n) {
+                if (!composite[n - lo])
+                    m_basePrimes.push_back(static_cast<uint32_t>(n));
+            }
+            m_generatedUpTo = hi;
+        }
+    }
+
+    // Recomeça a ativação dos primos de crivo e esvazia primos e buckets
+    void restartSievingPrimes()
+    {
+        m_primes.clear();
+        for (auto &bucket : m_buckets) bucket.clear();
+        m_baseIdx = 0;
+        m_pending.clear();
+        m_pendingIdx = 0;
+        if (m_source) m_source->reset(BASE_PRIME + 1, uint64_t(1) << 32);
+    }
+
+    // Próximo primo de crivo ainda não ativado (0 quando acabaram): primeiro
+    // os de m_basePrimes, depois os de m_source, um segmento por vez. Todos
+    // cabem em 32 bits: √(2⁶⁴) = 2³².
+    uint64_t nextSievingPrime(uint64_t need)
+    {
+        if (m_baseIdx == m_basePrimes.size()) generateBasePrimes(need);
+        if (m_baseIdx < m_basePrimes.size()) return m_basePrimes[m_baseIdx];
+        if (m_generatedUpTo < BASE_PRIME) return 0;
+
+        if (m_pendingIdx == m_pending.size()) {
+            if (!m_source)
+                m_source.reset(new PrimeSieve(BASE_PRIME + 1, uint64_t(1) << 32));
+            m_pending.clear();
+            m_pendingIdx = 0;
+            while (m_pending.empty() && m_source->nextSegment())
+                m_source->forEachPrime([&](uint64_t q) { m_pending.push_back(static_cast<uint32_t>(q)); });
+            if (m_pending.empty()) return 0;
+        }
+        return m_pending[m_pendingIdx];
+    }
+
+    // Ativa os primos > 47 cujo quadrado já cai neste segmento ou antes; dos
+    // acima de BASE_PRIME só ficam guardados os ainda não ativados (no
+    // máximo um segmento de m_source)
+    void addSievingPrimes(uint64_t lastSieved)
+    {
+        const uint64_t highN = segmentEnd();
+        const uint64_t need = std::min<uint64_t>(
+            static_cast<uint64_t>(std::sqrt(static_cast<double>(highN))) + 1, UINT32_MAX);
+        const uint64_t lowN = m_lowCycle * 210;
+        for (uint64_t p; (p = nextSievingPrime(need)) != 0 && p * p < highN;) {
+            if (m_baseIdx < m_basePrimes.size()) ++m_baseIdx;
+            else ++m_pendingIdx;
+            if (p <= PRESIEVE_LAST) continue;
+
+            // Primeiro multiplicador k >= max(p, ⌈low/p⌉) coprimo com 210
+            uint64_t k = std::max(p, lowN / p + (lowN % p != 0));
+            uint64_t kc = k / 210;
+            uint8_t ki = WheelTables::T.nextIndex[k % 210];
+            if (ki == Constants::WHEEL_SIZE) { ki = 0; ++kc; }
+            k = kc * 210 + Constants::WHEEL_OFFSETS[ki];
+
+            // Perto de 2⁶⁴, p·k pode passar de 64 bits (múltiplo além do
+            // segmento); o ciclo cabe em 64
+            const uint64_t cycle = static_cast<uint64_t>(uint128_t(p) * k / 210);
+            const uint32_t a = static_cast<uint32_t>(p / 210);
+            const uint8_t cls = WheelTables::T.residueIndex[p % 210];
+            if (p >= BUCKET_PRIME) {
+                schedule(a, cls, ki, cycle, lastSieved);
+                continue;
+            }
+            // O ciclo relativo, menor que p, cabe em 32 bits
+            m_primes.push_back({a, static_cast<uint32_t>(cycle - m_lowCycle), cls, ki});
+        }
+    }
+
+    // Põe o primo no bucket do segmento da grade que contém o ciclo absoluto
+    // cycle; depois de lastSieved ele não acerta mais nada e é descartado
+    void schedule(uint32_t a, unsigned cls, unsigned k, uint64_t cycle, uint64_t lastSieved)
+    {
+        if (cycle > lastSieved) return;
+        const uint64_t segment = cycle / SEGMENT_CYCLES;
+        const uint32_t pos = static_cast<uint32_t>(cls) << 22 | static_cast<uint32_t>(k) << 16
+                           | static_cast<uint32_t>(cycle - segment * SEGMENT_CYCLES);
+        m_buckets[segment & (m_buckets.size() - 1)].push_back({a, pos});
+    }
+
+    void crossOff()
+    {
+        const uint64_t end = m_numCycles;
+        uint64_t *words = m_words.data();
+        const auto &T = WheelTables::T;
+
+        for (SievingPrime &sp : m_primes) {
+            uint64_t cycle = sp.cycle;
+            unsigned k = sp.k;
+            const uint64_t a = sp.a;
+            const uint64_t p = 210 * a + Constants::WHEEL_OFFSETS[sp.cls];
+            const uint8_t *bit = T.bit[sp.cls];
+            const uint8_t *carry = T.carry[sp.cls];
+
+            // Primos pequenos: voltas completas da wheel (48 múltiplos em p
+            // ciclos) com posições precomputadas, sem dependência entre elas
+            if (2 * p < end) {
+                while (k != 0 && cycle < end) {
+                    uint64_t pos = cycle * 48 + bit[k];
+                    words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+                    cycle += a * T.gap[k] + carry[k];
+                    k = (k + 1 == Constants::WHEEL_SIZE) ? 0 : k + 1;
+                }
+
+                uint64_t turn[48];
+                for (int j = 0; j < Constants::WHEEL_SIZE; ++j)
+                    turn[j] = a * T.turnA[j] + T.turnB[sp.cls][j];
+                for (; k == 0 && cycle + p <= end; cycle += p) {
+                    const uint64_t base = cycle * 48;
+                    for (int j = 0; j < Constants::WHEEL_SIZE; ++j) {
+                        uint64_t pos = base + turn[j];
+                        words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+                    }
+                }
+            }
+
+            for (; cycle < end; k = (k + 1 == Constants::WHEEL_SIZE) ? 0 : k + 1) {
+                uint64_t pos = cycle * 48 + bit[k];
+                words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+                cycle += a * T.gap[k] + carry[k];
+            }
+
+            sp.cycle = static_cast<uint32_t>(cycle - end);
+            sp.k = static_cast<uint8_t>(k);
+        }
+    }
+
+    // Risca os acertos dos primos grandes deste segmento e reagenda cada um
+    // no bucket do segmento do próximo acerto, que nunca é este: o bucket é
+    // percorrido no lugar e esvaziado mantendo a capacidade. Fora da grade
+    // (primeiro segmento) o ciclo é corrigido pelo deslocamento do início.
+    void crossOffBucket(uint64_t lastSieved)
+    {
+        const uint64_t end = m_numCycles;
+        const uint64_t segment = m_lowCycle / SEGMENT_CYCLES;
+        const uint64_t offset = m_lowCycle - segment * SEGMENT_CYCLES;
+        uint64_t *words = m_words.data();
+        const auto &T = WheelTables::T;
+
+        std::vector<BucketEntry> &bucket = m_buckets[segment & (m_buckets.size() - 1)];
+        for (const BucketEntry &e : bucket) {
+            const unsigned cls = e.pos >> 22;
+            unsigned k = (e.pos >> 16) & 63;
+            uint64_t cycle = (e.pos & 0xFFFF) - offset;
+            const uint64_t a = e.a;
+            do {
+                const uint64_t pos = cycle * 48 + T.bit[cls][k];
+                words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+                cycle += a * T.gap[k] + T.carry[cls][k];
+                k = (k + 1 == Constants::WHEEL_SIZE) ? 0 : k + 1;
+            } while (cycle < end);
+            schedule(e.a, cls, k, m_lowCycle + cycle, lastSieved);
+        }
+        bucket.clear();
+    }
+
+    // Fim do segmento, saturado em 2⁶⁴ − 1: o último segmento da faixa de
+    // 64 bits passa de 2⁶⁴ (as posições além de m_limit são limpas)
+    uint64_t segmentEnd() const
+    {
+        const uint64_t endCycle = m_lowCycle + m_numCycles;
+        return endCycle > UINT64_MAX / 210 ? UINT64_MAX : endCycle * 210;
+    }
+
+    // Zera bits fora de [start, limit)
+    void clearOutside(uint64_t numWords)
+    {
+        const uint64_t base = m_lowCycle * 210;
+        const uint64_t segEnd = segmentEnd();
+        auto clearFrom = [&](uint64_t fromPos, uint64_t toPos) {
+            for (uint64_t pos = fromPos; pos < toPos; ++pos)
+                m_words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+        };
+        auto posOf = [&](uint64_t n) -> uint64_t {
+            uint64_t rel = n - base;
+            return rel / 210 * 48 + WheelTables::T.nextIndex[rel % 210];
+        };
+        if (m_start > base)
+            clearFrom(0, std::min(posOf(std::min(m_start, segEnd)), numWords * 64));
+        // segEnd saturado: as posições além de 2⁶⁴ − 1 (múltiplo de 3) dão a
+        // volta e são limpas mesmo com m_limit = UINT64_MAX
+        if (m_limit < segEnd || segEnd == UINT64_MAX)
+            clearFrom(posOf(m_limit), numWords * 64);
+    }
+
+    uint64_t m_start;
+    uint64_t m_limit;
+    uint64_t m_nextCycle;
+    uint64_t m_lowCycle = 0;
+    uint64_t m_numCycles = 0;
+    uint64_t m_numWords = 0;
+    std::vector<uint64_t> m_words;
+
+    std::vector<uint32_t> m_basePrimes;    // primos gerados até m_generatedUpTo ≤ BASE_PRIME
+    uint64_t m_generatedUpTo = 1;
+    size_t m_baseIdx = 0;                  // próximo de m_basePrimes a ativar
+    std::unique_ptr<PrimeSieve> m_source;  // primos de crivo de BASE_PRIME a 2³²
+    std::vector<uint32_t> m_pending;       // segmento atual de m_source
+    size_t m_pendingIdx = 0;               // próximo de m_pending a ativar
+    std::vector<SievingPrime> m_primes;    // primos < BUCKET_PRIME
+    std::vector<std::vector<BucketEntry>> m_buckets;   // anel indexado pelo segmento da grade
+
+    SegmentCache *m_cache = nullptr;
+    bool m_skipped = false;                // primos de crivo parados por acertos no cache
+};
+
+// v₂(n) = trailing zeros
+inline unsigned v2_of(uint64_t x) {
+    if (x == 0) return 0;
+    return __builtin_ctzll(x);
+}
+
+// Wheel iterator mod M (filtro rápido antes do Miller-Rabin), para n de 64
+// ou de 128 bits. Os primos que dividem M nunca aparecem. O laço só lê os
+// passos de Wheel<M> (φ(M) bytes: 48 B mod 210, 5,6 KiB mod 30030); o wheel
+// maior deixa menos candidatos por número: φ(M)/M = 22,9% mod 210 e 19,2%
+// mod 30030.
+template <typename N, int M = 210>
+class BasicWheelIterator {
+    using W = Constants::Wheel<M>;
+
+public:
+    BasicWheelIterator(N start) {
+        const N base = start / M * M;
+        const int r = static_cast<int>(start - base);
+        // Primeiro offset >= start; se não houver, o 1 do próximo ciclo
+        m_idx = static_cast<int>(std::lower_bound(W::T.offsets, W::T.offsets + W::SIZE, r) - W::T.offsets);
+        if (m_idx == W::SIZE) {
+            m_idx = 0;
+            m_n = base + M + 1;
+        } else {
+            m_n = base + W::T.offsets[m_idx];
+        }
+    }
+
+    N current() const {
+        return m_n;
+    }
+
+    void next() {
+        m_n += W::T.deltas[m_idx];
+        if (++m_idx == W::SIZE) m_idx = 0;
+    }
+
+private:
+    N m_n;
+    int m_idx;
+};
+
+using WheelIterator = BasicWheelIterator<uint64_t>;
+using WideWheelIterator = BasicWheelIterator<uint128_t>;
+template <int M>
+using WheelIteratorMod = BasicWheelIterator<uint64_t, M>;
+
+// ======================= PADRÕES DE k-UPLAS =======================
+
+// Um padrão admissível H = {0, h₂, ..., h_k} descreve as k-uplas de primos
+// (p, p + h₂, ..., p + h_k): twins {0,2}, cousins {0,4}, sexy {0,6},
+// trigêmeos {0,2,6} e {0,4,6}, quádruplos {0,2,6,8}. A lei geral
+//   kT_H(p) = (ln p)^k / C_H
+// usa a série singular de Hardy-Littlewood
+//   C_H = ∏_q (1 − ν_H(q)/q) / (1 − 1/q)^k,   ν_H(q) = #{h mod q : h ∈ H},
+// com C_{0,2} = 2C₂. Tudo o que depende só de H (classes mod 30, matriz de
+// gap_min, C_H e, no crivo, as classes mod 210 e os passeios) sai em tempo
+// de compilação.
+namespace TupleTables {
+    constexpr int MAX_SIZE = 8;
+    constexpr int MAX_CLASSES = 8;           // φ(30)
+    constexpr int MAX_SPAN = 46;             // t = r + h_k ≤ 255 nos passeios mod 210
+
+    // Produto explícito até q < SERIES_BOUND. Na cauda (ν = k) o log de cada
+    // fator é ∑ₘ (k − kᵐ)/(m·qᵐ); os termos m = 2, 3 somados sobre os primos
+    // saem da função zeta prima P(m) = ∑ 1/qᵐ, e o resto é O(q⁻⁴)
+    constexpr int SERIES_BOUND = 1 << 14;
+    constexpr long double PRIME_ZETA_2 = 0.4522474200410654985065433648L;
+    constexpr long double PRIME_ZETA_3 = 0.1747626392994435364231133147L;
+
+    struct Shape {
+        int size = 0;                        // k = |H|
+        int offsets[MAX_SIZE] = {};
+        int span = 0;                        // h_k
+        bool admissible = false;
+        int classCount = 0;                  // resíduos de p mod 30
+        int classes[MAX_CLASSES] = {};
+        int8_t classOf[30] = {};             // índice em classes; -1 fora
+        int gapMin[MAX_CLASSES][MAX_CLASSES] = {};
+        long double singularSeries = 0;      // C_H
+    };
+
+    // ν_H(q): resíduos distintos de H mod q
+    constexpr int residueCount(const Shape &s, int q)
+    {
+        int nu = 0;
+        for (int i = 0; i < s.size; ++i) {
+            bool repeated = false;
+            for (int j = 0; j < i; ++j)
+                repeated = repeated || (s.offsets[i] - s.offsets[j]) % q == 0;
+            nu += !repeated;
+        }
+        return nu;
+    }
+
+    constexpr long double singularSeries(const Shape &s)
+    {
+        bool composite[SERIES_BOUND] = {};
+        long double product = 1, tail2 = PRIME_ZETA_2, tail3 = PRIME_ZETA_3;
+        for (int q = 2; q < SERIES_BOUND; ++q) {
+            if (composite[q]) continue;
+            for (int m = q * q; m < SERIES_BOUND; m += q)
+                composite[m] = true;
+            const long double inv = 1.0L / q;
+            long double factor = 1 - residueCount(s, q) * inv;
+            for (int i = 0; i < s.size; ++i)
+                factor /= 1 - inv;
+            product *= factor;
+            tail2 -= inv * inv;
+            tail3 -= inv * inv * inv;
+        }
+        const long double k = s.size;
+        const long double logTail = (k - k * k) / 2 * tail2 + (k - k * k * k) / 3 * tail3;
+        return product * (1 + logTail + logTail * logTail / 2);
+    }
+
+    template <size_t K>
+    constexpr Shape buildShape(const int (&h)[K])
+    {
+        Shape s{};
+        s.size = static_cast<int>(K);
+        for (size_t i = 0; i < K; ++i) s.offsets[i] = h[i];
+        s.span = h[K - 1];
+
+        // Crescente a partir de 0 e sem cobrir todos os resíduos de nenhum
+        // q ≤ k (os demais primos nunca são cobertos)
+        s.admissible = h[0] == 0;
+        for (size_t i = 1; i < K; ++i)
+            s.admissible = s.admissible && h[i] > h[i - 1];
+        for (int q = 2; q <= s.size; ++q)
+            s.admissible = s.admissible && residueCount(s, q) < q;
+        if (!s.admissible) return s;
+
+        // Classes de p mod 30: todos os p + h coprimos com 30
+        for (int r = 0; r < 30; ++r) {
+            bool ok = true;
+            for (int i = 0; i < s.size; ++i) {
+                const int n = r + s.offsets[i];
+                ok = ok && n % 2 != 0 && n % 3 != 0 && n % 5 != 0;
+            }
+            s.classOf[r] = static_cast<int8_t>(ok ? s.classCount : -1);
+            if (ok) s.classes[s.classCount++] = r;
+        }
+        // Entre k-uplas consecutivas das classes i → j o gap é ≡ r_j − r_i
+        // (mod 30) e positivo: o menor é esse resíduo em [1, 30]
+        for (int i = 0; i < s.classCount; ++i)
+            for (int j = 0; j < s.classCount; ++j)
+                s.gapMin[i][j] = (s.classes[j] - s.classes[i] + 29) % 30 + 1;
+
+        s.singularSeries = singularSeries(s);
+        return s;
+    }
+}
+
+template <int... H>
+struct TuplePattern {
+    static_assert(sizeof...(H) >= 2 && sizeof...(H) <= TupleTables::MAX_SIZE, "2 ≤ k ≤ 8");
+    static constexpr TupleTables::Shape S = TupleTables::buildShape<sizeof...(H)>({H...});
+    static_assert(S.admissible, "padrão não admissível");
+    static_assert(S.span <= TupleTables::MAX_SPAN, "h_k grande demais para os passeios mod 210");
+};
+
+using TwinPattern = TuplePattern<0, 2>;
+using CousinPattern = TuplePattern<0, 4>;
+using SexyPattern = TuplePattern<0, 6>;
+using TripletPattern = TuplePattern<0, 2, 6>;
+using TripletPatternAlt = TuplePattern<0, 4, 6>;
+using QuadrupletPattern = TuplePattern<0, 2, 6, 8>;
+
+namespace TupleTables {
+    // O padrão dos twins reproduz as tabelas fixas de Constants e 2C₂
+    constexpr bool matchesTwinConstants(const Shape &s)
+    {
+        if (s.classCount != 3) return false;
+        for (int i = 0; i < 3; ++i) {
+            if (s.classes[i] != Constants::TWIN_CLASSES[i]) return false;
+            for (int j = 0; j < 3; ++j)
+                if (s.gapMin[i][j] != Constants::GAP_MIN[i][j]) return false;
+        }
+        const long double error = s.singularSeries - 2 * Constants::C2;
+        return error < 1e-12L && error > -1e-12L;
+    }
+    static_assert(matchesTwinConstants(TwinPattern::S), "TuplePattern<0, 2> ≠ TWIN_CLASSES/GAP_MIN/2C₂");
+
+    template <class... P>
+    struct PatternList {};
+}
+
+// Padrões com crivo instanciado (a CLI escolhe entre eles pelos offsets)
+using KnownTuplePatterns = TupleTables::PatternList<TwinPattern, CousinPattern, SexyPattern,
+                                                    TripletPattern, TripletPatternAlt, QuadrupletPattern>;
+
+template <class F, class... P>
+inline bool visitTuplePattern(const std::vector<int> &offsets, F &&f, TupleTables::PatternList<P...>)
+{
+    auto matches = [&](const TupleTables::Shape &s) {
+        return offsets.size() == static_cast<size_t>(s.size)
+            && std::equal(offsets.begin(), offsets.end(), s.offsets);
+    };
+    return ((matches(P::S) && (f(P{}), true)) || ...);
+}
+
+// Chama f(P{}) para o padrão conhecido com esses offsets; false se nenhum
+template <class F>
+inline bool visitTuplePattern(const std::vector<int> &offsets, F &&f)
+{
+    return visitTuplePattern(offsets, std::forward<F>(f), KnownTuplePatterns{});
+}
+
+// ======================= CRIVO DE k-UPLAS =======================
+
+// Resíduos r mod 210 com todos os r + h coprimos com 210: toda k-upla com
+// p ≥ 11 cai numa destas classes (twins: 15, quádruplos: 3).
+//
+// Passeio da wheel para um primo de crivo p = 210a + r (r = offset da
+// classe ci): os múltiplos p·k que caem em algum membro de k-upla, isto é
+// p·k ≡ t (mod 210) com t ∈ {r_j + h}, são os k de HITS resíduos mod 210.
+// Com n = 210c + t (c = ciclo da k-upla), do i-ésimo ao (i+1)-ésimo k
+// (ordem crescente, com volta) o ciclo avança
+//   a·dk[ci][i] + dc[ci][i],   dc = (r·dk + t_i - t_{i+1}) / 210
+namespace TupleTables {
+    constexpr bool fitsClass210(const Shape &s, int r)
+    {
+        for (int i = 0; i < s.size; ++i)
+            if (WheelTables::T.residueIndex[(r + s.offsets[i]) % 210] == 0xFF) return false;
+        return true;
+    }
+
+    constexpr int classCount210(const Shape &s)
+    {
+        int n = 0;
+        for (int k = 0; k < Constants::WHEEL_SIZE; ++k)
+            n += fitsClass210(s, Constants::WHEEL_OFFSETS[k]);
+        return n;
+    }
+
+    template <int COUNT, int HITS>
+    struct ResidueTable {
+        uint8_t r[COUNT] = {};
+        uint8_t t[HITS] = {};          // t_i = r_{i / k} + h_{i mod k}
+        int8_t delta[HITS] = {};       // (t_i − t_{i−1}) / 2
+        int maxDelta = 0;
+    };
+
+    template <int COUNT, int HITS>
+    constexpr ResidueTable<COUNT, HITS> buildResidues(const Shape &s)
+    {
+        ResidueTable<COUNT, HITS> t{};
+        int n = 0;
+        for (int k = 0; k < Constants::WHEEL_SIZE; ++k)
+            if (fitsClass210(s, Constants::WHEEL_OFFSETS[k]))
+                t.r[n++] = static_cast<uint8_t>(Constants::WHEEL_OFFSETS[k]);
+        for (int i = 0; i < HITS; ++i) {
+            t.t[i] = static_cast<uint8_t>(t.r[i / s.size] + s.offsets[i % s.size]);
+            if (i == 0) continue;
+            const int d = (t.t[i] - t.t[i - 1]) / 2;
+            t.delta[i] = static_cast<int8_t>(d);
+            t.maxDelta = std::max(t.maxDelta, d < 0 ? -d : d);
+        }
+        return t;
+    }
+
+    template <int HITS>
+    struct WalkTable {
+        uint8_t k[48][HITS] = {};         // resíduos de k mod 210, crescentes
+        uint8_t cls[48][HITS] = {};       // classe j da k-upla atingida
+        uint8_t t[48][HITS] = {};
+        uint8_t dk[48][HITS] = {};
+        int16_t dc[48][HITS] = {};
+        uint8_t firstHit[48][210] = {};   // primeiro i com k_i ≥ k mod 210 (HITS = volta)
+    };
+
+    template <int COUNT, int HITS>
+    constexpr WalkTable<HITS> buildWalk(const Shape &s, const ResidueTable<COUNT, HITS> &res)
+    {
+        WalkTable<HITS> w{};
+        for (int ci = 0; ci < Constants::WHEEL_SIZE; ++ci) {
+            const int r = Constants::WHEEL_OFFSETS[ci];
+            int rInv = 1;
+            while (r * rInv % 210 != 1) ++rInv;
+
+            // Inserção em ordem de k; t ≡ t' (mod 210) só acontece entre
+            // classes a distância h e fica em ordem decrescente de t, para
+            // que o ciclo nunca recue
+            for (int i = 0; i < HITS; ++i) {
+                const int t = res.t[i];
+                const int kk = t % 210 * rInv % 210;
+                int n = i;
+                for (; n > 0 && (w.k[ci][n - 1] > kk || (w.k[ci][n - 1] == kk && w.t[ci][n - 1] < t)); --n) {
+                    w.k[ci][n] = w.k[ci][n - 1];
+                    w.cls[ci][n] = w.cls[ci][n - 1];
+                    w.t[ci][n] = w.t[ci][n - 1];
+                }
+                w.k[ci][n] = static_cast<uint8_t>(kk);
+                w.cls[ci][n] = static_cast<uint8_t>(i / s.size);
+                w.t[ci][n] = static_cast<uint8_t>(t);
+            }
+            for (int i = 0; i < HITS; ++i) {
+                const int next = (i + 1) % HITS;
+                const int dk = (i + 1 < HITS) ? w.k[ci][next] - w.k[ci][i] : 210 + w.k[ci][0] - w.k[ci][i];
+                w.dk[ci][i] = static_cast<uint8_t>(dk);
+                w.dc[ci][i] = static_cast<int16_t>((r * dk + w.t[ci][i] - w.t[ci][next]) / 210);
+            }
+            for (int kk = 0, i = 0; kk < 210; ++kk) {
+                while (i < HITS && w.k[ci][i] < kk) ++i;
+                w.firstHit[ci][kk] = static_cast<uint8_t>(i);
+            }
+        }
+        return w;
+    }
+}
+
+// 210⁻¹ mod p (Euclides estendido; p ≥ 11 primo)
+inline uint64_t inverse210(uint64_t p)
+{
+    int64_t r0 = static_cast<int64_t>(p), r1 = 210 % static_cast<int64_t>(p);
+    int64_t s0 = 0, s1 = 1;
+    while (r1 != 0) {
+        const int64_t q = r0 / r1;
+        std::swap(r0, r1); r1 -= q * r0;
+        std::swap(s0, s1); s1 -= q * s0;
+    }
+    return static_cast<uint64_t>(s0 < 0 ? s0 + static_cast<int64_t>(p) : s0);
+}
+
+template <class Pattern>
+struct TupleResidues {
+    static constexpr int SIZE = Pattern::S.size;
+    static constexpr int SPAN = Pattern::S.span;
+    static constexpr int COUNT = TupleTables::classCount210(Pattern::S);
+    // Cada primo de crivo risca SIZE progressões por classe (p | n + h)
+    static constexpr int HITS = SIZE * COUNT;
+
+    static constexpr TupleTables::ResidueTable<COUNT, HITS> T =
+        TupleTables::buildResidues<COUNT, HITS>(Pattern::S);
+    static constexpr TupleTables::WalkTable<HITS> W = TupleTables::buildWalk(Pattern::S, T);
+
+    // Primeiro ciclo, relativo a um ciclo inicial ≡ lowMod (mod p), de cada
+    // uma das HITS progressões de p: rel[i] para t = T.t[i].
+    // c(t) ≡ -t·210⁻¹ (mod p); de um t para o seguinte basta somar ou
+    // subtrair |δ|·2·210⁻¹ mod p, com |δ| ≤ T.maxDelta
+    static void firstCycles(uint64_t p, uint64_t inv, uint64_t lowMod, uint64_t rel[HITS])
+    {
+        uint64_t stepInv[T.maxDelta + 1] = {0};
+        for (int k = 1; k <= T.maxDelta; ++k) {
+            stepInv[k] = stepInv[k - 1] + 2 * inv % p;
+            if (stepInv[k] >= p) stepInv[k] -= p;
+        }
+        uint64_t c0 = (p - T.t[0] % p) % p * inv % p;
+        for (int i = 0; i < HITS; ++i) {
+            if (T.delta[i] > 0) {
+                const uint64_t step = stepInv[T.delta[i]];
+                c0 = c0 >= step ? c0 - step : c0 + p - step;
+            } else if (T.delta[i] < 0) {
+                c0 += stepInv[-T.delta[i]];
+                if (c0 >= p) c0 -= p;
+            }
+            rel[i] = c0 >= lowMod ? c0 - lowMod : c0 + p - lowMod;
+        }
+    }
+};
+
+using TwinResidues = TupleResidues<TwinPattern>;
+static_assert(TwinResidues::COUNT == 15, "15 classes de twins mod 210");
+
+// Crivo só de k-uplas do padrão H (o modo Twins usa H = {0, 2}). Um bitmap
+// por classe de TupleResidues, um bit por ciclo de 210: o bit (j, c)
+// representa a k-upla que começa em 210c + r_j e continua 1 enquanto nenhum
+// primo de crivo dividir um dos seus membros. Cada primo p ≥ 11 risca, em
+// cada classe, k progressões de passo p (p | n + h); não há bookkeeping por
+// primo. O laço interno é instanciado por padrão: k, as classes e os
+// passeios são constantes de compilação.
+//  - primos < SEGMENT_CYCLES guardam o próximo ciclo de cada progressão e
+//    riscam classe por classe (bitmap no L1);
+//  - os maiores percorrem os seus múltiplos nas k-uplas com TupleResidues::W
+//    (um estado por primo) e esperam em buckets, um por segmento futuro,
+//    até o segmento do próximo acerto.
+// Enumera em ordem crescente os p das k-uplas com p em [start, limit) e
+// p ≥ 11 (as que contêm 2, 3, 5 ou 7 ficam de fora).
+template <class Pattern>
+class TupleSieve {
+    using Residues = TupleResidues<Pattern>;
+
+public:
+    // Twins: 15 bitmaps de 16 KiB, o segmento inteiro cabe no L2, uma classe no L1
+    static constexpr uint64_t SEGMENT_SHIFT = 17;
+    static constexpr uint64_t SEGMENT_CYCLES = uint64_t(1) << SEGMENT_SHIFT;
+    static constexpr uint64_t SEGMENT_WORDS = SEGMENT_CYCLES / 64;
+
+    explicit TupleSieve(uint64_t start = 0, uint64_t limit = UINT64_MAX)
+        : m_bits(Residues::COUNT * SEGMENT_WORDS), m_source(0, uint64_t(1) << 32)
+    {
+        reset(start, limit);
+    }
+
+    // Reposiciona em [start, limit) reaproveitando os primos de crivo gerados
+    void reset(uint64_t start, uint64_t limit)
+    {
+        m_start = std::max<uint64_t>(start, 11);
+        m_limit = limit;
+        m_nextCycle = m_start / 210;
+        m_numCycles = 0;
+        m_segment = 0;
+        m_active = 0;
+        m_activeSmall = 0;
+        for (auto &next : m_next) next.clear();
+
+        // Um primo p acerta até ⌈p / SEGMENT_CYCLES⌉ + 1 segmentos à frente
+        const uint64_t maxPrime = static_cast<uint64_t>(std::sqrt(static_cast<double>(limit))) + 1;
+        size_t ring = 2;
+        while (ring < (std::min<uint64_t>(maxPrime, UINT32_MAX) >> SEGMENT_SHIFT) + 2)
+            ring *= 2;
+        m_buckets.resize(ring);
+        for (auto &bucket : m_buckets) bucket.clear();
+    }
+
+    // Crivo do próximo segmento; false quando passou de limit
+    bool nextSegment()
+    {
+        if (m_start >= m_limit || m_nextCycle > (m_limit - 1) / 210)
+            return false;
+
+        if (m_numCycles > 0) ++m_segment;
+        m_lowCycle = m_nextCycle;
+        m_numCycles = std::min<uint64_t>(SEGMENT_CYCLES, (m_limit - 1) / 210 - m_lowCycle + 1);
+        m_nextCycle = m_lowCycle + m_numCycles;
+
+        activateSievingPrimes();
+        for (int j = 0; j < Residues::COUNT; ++j)
+            crossOffSmall(j);
+        crossOffBucket();
+        return true;
+    }
+
+    uint64_t segmentLow() const { return m_lowCycle * 210; }
+    // Saturado: o último segmento da faixa de 64 bits passa de 2⁶⁴
+    uint64_t segmentHigh() const
+    {
+        return m_nextCycle > UINT64_MAX / 210 ? m_limit : std::min(m_limit, m_nextCycle * 210);
+    }
+    // Inícios de k-upla candidatos no segmento (um bit por classe e ciclo)
+    uint64_t segmentCandidates() const { return m_numCycles * Residues::COUNT; }
+
+    // Chama f(p) para cada k-upla (p, ..., p + h_k) do segmento atual, em
+    // ordem crescente
+    template <typename F>
+    void forEachTuple(F &&f) const
+    {
+        const uint64_t numWords = (m_numCycles + 63) / 64;
+        for (uint64_t w = 0; w < numWords; ++w) {
+            uint64_t any = 0;
+            for (int j = 0; j < Residues::COUNT; ++j)
+                any |= m_bits[j * SEGMENT_WORDS + w];
+            while (any) {
+                const unsigned bit = __builtin_ctzll(any);
+                any &= any - 1;
+                const uint64_t base = (m_lowCycle + w * 64 + bit) * 210;
+                for (int j = 0; j < Residues::COUNT; ++j) {
+                    if ((m_bits[j * SEGMENT_WORDS + w] >> bit) & 1)
+                        f(base + Residues::T.r[j]);
+                }
+            }
+        }
+    }
+
+private:
+    struct PoolPrime {
+        uint32_t p;
+        uint32_t inv;   // 210⁻¹ mod p
+    };
+
+    // Primo grande p = 210a + r_ci no bucket do segmento do próximo acerto
+    struct BucketEntry {
+        uint32_t a;
+        uint32_t pos;   // (ci << CI_SHIFT) | (i << SEGMENT_SHIFT) | ciclo no segmento
+    };
+    static constexpr int hitBits()
+    {
+        int bits = 0;
+        while ((1 << bits) < Residues::HITS) ++bits;
+        return bits;
+    }
+    static constexpr int CI_SHIFT = SEGMENT_SHIFT + hitBits();
+    static_assert(CI_SHIFT + 6 <= 32, "ci, i e ciclo cabem em 32 bits");
+
+    // Ativa os primos com p² ≤ maior membro de k-upla do segmento, gerando-os
+    // sob demanda com um PrimeSieve, e calcula o primeiro ciclo das suas
+    // HITS progressões. high satura em 2⁶⁴ − 1, e os primos de crivo param
+    // em 2³² (m_source), então cabem no uint32_t do pool.
+    void activateSievingPrimes()
+    {
+        const uint64_t high = static_cast<uint64_t>(std::min<uint128_t>(
+            uint128_t(m_nextCycle) * 210 + Residues::SPAN - 1, UINT64_MAX));
+        while (m_generatedUpTo <= high / m_generatedUpTo) {
+            if (!m_source.nextSegment()) break;
+            m_source.forEachPrime([&](uint64_t q) {
+                m_pool.push_back({static_cast<uint32_t>(q), static_cast<uint32_t>(inverse210(q))});
+            });
+            m_generatedUpTo = m_source.segmentHigh();
+        }
+
+        for (; m_active < m_pool.size(); ++m_active) {
+            const uint64_t p = m_pool[m_active].p;
+            if (p > high / p) break;
+
+            if (p >= SEGMENT_CYCLES) {
+                activateLarge(p);
+                continue;
+            }
+            ++m_activeSmall;
+
+            uint64_t rel[Residues::HITS];
+            Residues::firstCycles(p, m_pool[m_active].inv, m_lowCycle % p, rel);
+            for (int i = 0; i < Residues::HITS; ++i) {
+                if (uint128_t(m_lowCycle + rel[i]) * 210 + Residues::T.t[i] == p)
+                    rel[i] += p;   // o próprio p não é riscado
+                m_next[i / Residues::SIZE].push_back(static_cast<uint32_t>(rel[i]));
+            }
+        }
+    }
+
+    // Primeiro múltiplo p·k (k ≥ 2) que cai numa k-upla com ciclo ≥ m_lowCycle.
+    // Perto de 2⁶⁴, 210·m_lowCycle e p·k passam de 64 bits: contas em 128.
+    void activateLarge(uint64_t p)
+    {
+        const auto &W = Residues::W;
+        const uint64_t a = p / 210;
+        const int ci = WheelTables::T.residueIndex[p % 210];
+
+        const uint64_t kMin = std::max<uint64_t>(2, static_cast<uint64_t>(uint128_t(m_lowCycle) * 210 / p));
+        uint64_t m = kMin / 210;
+        int i = W.firstHit[ci][kMin % 210];
+        if (i == Residues::HITS) { ++m; i = 0; }
+        uint64_t c = static_cast<uint64_t>((uint128_t(p) * (210 * m + W.k[ci][i]) - W.t[ci][i]) / 210);
+        while (c < m_lowCycle) {
+            c += a * W.dk[ci][i] + W.dc[ci][i];
+            if (++i == Residues::HITS) i = 0;
+        }
+        schedule(static_cast<uint32_t>(a), ci, i, m_segment, c - m_lowCycle);
+    }
+
+    // Põe o primo no bucket do segmento (a partir de segment) que contém rel
+    void schedule(uint32_t a, int ci, int i, uint64_t segment, uint64_t rel)
+    {
+        const uint64_t target = segment + (rel >> SEGMENT_SHIFT);
+        const uint32_t pos = static_cast<uint32_t>(ci) << CI_SHIFT
+                           | static_cast<uint32_t>(i) << SEGMENT_SHIFT
+                           | static_cast<uint32_t>(rel & (SEGMENT_CYCLES - 1));
+        m_buckets[target & (m_buckets.size() - 1)].push_back({a, pos});
+    }
+
+    // Liga todas as k-uplas da classe j e risca as progressões dos primos
+    // pequenos; os próximos ciclos ficam relativos ao segmento seguinte
+    void crossOffSmall(int j)
+    {
+        uint64_t *words = &m_bits[j * SEGMENT_WORDS];
+        const uint64_t numWords = (m_numCycles + 63) / 64;
+        std::fill(words, words + numWords, ~uint64_t(0));
+
+        uint32_t *next = m_next[j].data();
+        for (size_t i = 0; i < m_activeSmall; ++i) {
+            const uint32_t p = m_pool[i].p;
+            for (int s = 0; s < Residues::SIZE; ++s) {
+                uint64_t c = next[Residues::SIZE * i + s];
+                for (; c < m_numCycles; c += p)
+                    words[c / 64] &= ~(uint64_t(1) << (c % 64));
+                next[Residues::SIZE * i + s] = static_cast<uint32_t>(c - m_numCycles);
+            }
+        }
+
+        clearOutside(words, numWords, Residues::T.r[j]);
+    }
+
+    // Risca os acertos dos primos grandes neste segmento e reagenda cada um
+    // no bucket do próximo segmento que ele acerta. Como o reagendamento
+    // nunca cai neste mesmo bucket, ele é percorrido no lugar e esvaziado
+    // mantendo a capacidade (cada bucket estabiliza, sem realocações).
+    void crossOffBucket()
+    {
+        const auto &W = Residues::W;
+        std::vector<BucketEntry> &bucket = m_buckets[m_segment & (m_buckets.size() - 1)];
+        for (const BucketEntry &e : bucket) {
+            const int ci = e.pos >> CI_SHIFT;
+            int i = (e.pos >> SEGMENT_SHIFT) & ((1u << (CI_SHIFT - SEGMENT_SHIFT)) - 1);
+            uint64_t c = e.pos & (SEGMENT_CYCLES - 1);
+            do {
+                const uint64_t bit = W.cls[ci][i] * SEGMENT_WORDS * 64 + c;
+                m_bits[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+                c += uint64_t(e.a) * W.dk[ci][i] + W.dc[ci][i];
+                if (++i == Residues::HITS) i = 0;
+            } while (c < SEGMENT_CYCLES);
+            schedule(e.a, ci, i, m_segment, c);
+        }
+        bucket.clear();
+    }
+
+    // Apaga as k-uplas com p fora de [start, limit) e os bits além do segmento
+    void clearOutside(uint64_t *words, uint64_t numWords, uint64_t r) const
+    {
+        auto clearRange = [&](uint64_t from, uint64_t to) {
+            for (uint64_t c = from; c < to; ++c)
+                words[c / 64] &= ~(uint64_t(1) << (c % 64));
+        };
+        // Em 128 bits: no último ciclo da faixa, 210c + r passa de 2⁶⁴
+        const uint128_t base = uint128_t(m_lowCycle) * 210 + r;
+        // Primeiro ciclo com 210c + r ≥ start
+        if (m_start > base)
+            clearRange(0, std::min<uint64_t>((m_start - base + 209) / 210, m_numCycles));
+        // Primeiro ciclo com 210c + r ≥ limit
+        uint64_t end = m_numCycles;
+        if (m_limit <= base)
+            end = 0;
+        else if ((m_limit - base + 209) / 210 < end)
+            end = static_cast<uint64_t>((m_limit - base + 209) / 210);
+        clearRange(end, numWords * 64);
+    }
+
+    uint64_t m_start = 0;
+    uint64_t m_limit = UINT64_MAX;
+    uint64_t m_nextCycle = 0;
+    uint64_t m_lowCycle = 0;
+    uint64_t m_numCycles = 0;
+    uint64_t m_segment = 0;                // índice do segmento desde o reset
+    std::vector<uint64_t> m_bits;
+
+    PrimeSieve m_source;                   // gera os primos de crivo (11 a 2³²)
+    std::vector<PoolPrime> m_pool;         // primos gerados até m_generatedUpTo
+    uint64_t m_generatedUpTo = 1;
+    size_t m_active = 0;                   // m_pool[0..m_active) em uso
+    size_t m_activeSmall = 0;              // desses, os < SEGMENT_CYCLES
+    std::vector<uint32_t> m_next[Residues::COUNT];       // SIZE progressões por primo pequeno
+    std::vector<std::vector<BucketEntry>> m_buckets;     // anel indexado por segmento
+};
+
+// O crivo do modo Twins
+using TwinSieve = TupleSieve<TwinPattern>;
+
+// ======================= CRIVO DE PARES ACIMA DE 2⁶⁴ =======================
+
+// Versão de janela do TwinSieve para p de 128 bits, no mesmo layout (15
+// bitmaps, um bit por ciclo de 210). Acima de 2⁶⁴ um crivo completo pediria
+// primos até 2³², e cada um custa uma redução de 128 bits por segmento mesmo
+// sem acertar a janela. Os primos de crivo param em SIEVE_BOUND e, quando
+// isso não chega a √limit, os pares sobreviventes passam pelo BailliePSW
+// (os dois membros). Sem estado por primo entre segmentos: cada segmento
+// recalcula os primeiros ciclos, então o crivo serve a janelas curtas
+// (algumas dezenas de segmentos), não a varreduras longas.
+class WideTwinSieve {
+public:
+    // Cada segmento custa uma passada por todos os primos de crivo: segmentos
+    // 8× maiores que os do TwinSieve (15 bitmaps de 128 KiB, 2,2·10⁸ números)
+    static constexpr uint64_t SEGMENT_CYCLES = uint64_t(1) << 20;
+    static constexpr uint64_t SEGMENT_WORDS = SEGMENT_CYCLES / 64;
+    // Medido em 10²⁰: de 2²² a 2²⁶ o tempo dos testes BPSW quase não cai,
+    // enquanto o do crivo cresce com o número de primos
+    static constexpr uint64_t SIEVE_BOUND = uint64_t(1) << 22;
+
+    explicit WideTwinSieve(uint128_t start = 0, uint128_t limit = 0)
+        : m_bits(TwinResidues::COUNT * SEGMENT_WORDS)
+    {
+        reset(start, limit);
+    }
+
+    // Reposiciona em [start, limit) reaproveitando os primos de crivo gerados
+    void reset(uint128_t start, uint128_t limit)
+    {
+        m_start = start;
+        m_limit = limit;
+        m_nextCycle = start / 210;
+        m_numCycles = 0;
+
+        // Maior membro de par: limit; crivo completo se SIEVE_BOUND ≥ √limit
+        const uint64_t root = isqrtWide(limit);
+        m_complete = root < SIEVE_BOUND;
+        m_bound = m_complete ? root + 1 : SIEVE_BOUND;
+        if (m_generatedUpTo < m_bound) {
+            PrimeSieve source(m_generatedUpTo + 1, SIEVE_BOUND + 1);
+            while (m_generatedUpTo < m_bound && source.nextSegment()) {
+                source.forEachPrime([&](uint64_t q) {
+                    m_pool.push_back({static_cast<uint32_t>(q),
+                                      static_cast<uint32_t>(inverse210(q))});
+                });
+                m_generatedUpTo = source.segmentHigh() - 1;
+            }
+        }
+    }
+
+    // Crivo do próximo segmento; false quando passou de limit
+    bool nextSegment()
+    {
+        if (m_start >= m_limit || m_nextCycle > (m_limit - 1) / 210)
+            return false;
+
+        m_lowCycle = m_nextCycle;
+        m_numCycles = static_cast<uint64_t>(
+            std::min<uint128_t>(SEGMENT_CYCLES, (m_limit - 1) / 210 - m_lowCycle + 1));
+        m_nextCycle = m_lowCycle + m_numCycles;
+
+        const uint64_t numWords = (m_numCycles + 63) / 64;
+        for (int j = 0; j < TwinResidues::COUNT; ++j)
+            std::fill_n(&m_bits[j * SEGMENT_WORDS], numWords, ~uint64_t(0));
+        crossOff();
+        for (int j = 0; j < TwinResidues::COUNT; ++j)
+            clearOutside(&m_bits[j * SEGMENT_WORDS], numWords, TwinResidues::T.r[j]);
+        return true;
+    }
+
+    uint128_t segmentLow() const { return m_lowCycle * 210; }
+    uint128_t segmentHigh() const { return std::min(m_limit, m_nextCycle * 210); }
+
+    // true se os primos de crivo chegam a √limit (nenhum teste de primalidade)
+    bool complete() const { return m_complete; }
+
+    // Chama f(p) para cada twin (p, p+2) do segmento atual, em ordem crescente
+    template <typename F>
+    void forEachTwin(F &&f) const
+    {
+        const uint64_t numWords = (m_numCycles + 63) / 64;
+        for (uint64_t w = 0; w < numWords; ++w) {
+            uint64_t any = 0;
+            for (int j = 0; j < TwinResidues::COUNT; ++j)
+                any |= m_bits[j * SEGMENT_WORDS + w];
+            while (any) {
+                const unsigned bit = __builtin_ctzll(any);
+                any &= any - 1;
+                const uint128_t base = (m_lowCycle + w * 64 + bit) * 210;
+                for (int j = 0; j < TwinResidues::COUNT; ++j) {
+                    if (!((m_bits[j * SEGMENT_WORDS + w] >> bit) & 1)) continue;
+                    const uint128_t p = base + TwinResidues::T.r[j];
+                    if (m_complete || (BailliePSW::isPrime(p) && BailliePSW::isPrime(p + 2)))
+                        f(p);
+                }
+            }
+        }
+    }
+
+private:
+    struct PoolPrime {
+        uint32_t p;
+        uint32_t inv;   // 210⁻¹ mod p
+    };
+
+    // Uma redução de 128 bits por primo; as 30 progressões saem dela
+    void crossOff()
+    {
+        // O próprio p só pode cair no segmento se ele começa abaixo de SIEVE_BOUND
+        const bool selfCheck = m_lowCycle * 210 <= m_bound;
+        for (const PoolPrime &pp : m_pool) {
+            const uint64_t p = pp.p;
+            if (p > m_bound) break;
+            uint64_t rel[TwinResidues::HITS];
+            TwinResidues::firstCycles(p, pp.inv, static_cast<uint64_t>(m_lowCycle % p), rel);
+            for (int i = 0; i < TwinResidues::HITS; ++i) {
+                uint64_t c = rel[i];
+                if (c >= m_numCycles) continue;
+                if (selfCheck && (m_lowCycle + c) * 210 + TwinResidues::T.t[i] == p)
+                    c += p;
+                uint64_t *words = &m_bits[(i / TwinResidues::SIZE) * SEGMENT_WORDS];
+                for (; c < m_numCycles; c += p)
+                    words[c / 64] &= ~(uint64_t(1) << (c % 64));
+            }
+        }
+    }
+
+    // Apaga os pares com p fora de [start, limit) e os bits além do segmento
+    void clearOutside(uint64_t *words, uint64_t numWords, uint64_t r) const
+    {
+        auto clearRange = [&](uint64_t from, uint64_t to) {
+            for (uint64_t c = from; c < to; ++c)
+                words[c / 64] &= ~(uint64_t(1) << (c % 64));
+        };
+        const uint128_t base = m_lowCycle * 210 + r;
+        if (m_start > base)
+            clearRange(0, static_cast<uint64_t>(std::min<uint128_t>((m_start - base + 209) / 210, m_numCycles)));
+        uint64_t end = m_numCycles;
+        if (m_limit <= base)
+            end = 0;
+        else if ((m_limit - base + 209) / 210 < end)
+            end = static_cast<uint64_t>((m_limit - base + 209) / 210);
+        clearRange(end, numWords * 64);
+    }
+
+    uint128_t m_start = 0;
+    uint128_t m_limit = 0;
+    uint128_t m_nextCycle = 0;
+    uint128_t m_lowCycle = 0;
+    uint64_t m_numCycles = 0;
+    uint64_t m_bound = 0;                  // maior primo de crivo usado
+    bool m_complete = true;
+    std::vector<uint64_t> m_bits;
+
+    std::vector<PoolPrime> m_pool;         // primos ≥ 11 até m_generatedUpTo
+    uint64_t m_generatedUpTo = 10;
+};
+
+// ======================= ACUMULADORES =======================
+
+// Somas de um trecho contíguo da varredura. Dois acumuladores de trechos
+// consecutivos se combinam com merge(): o gap entre o último primo de um e o
+// primeiro do outro (e o twin que eventualmente o atravessa) é costurado na
+// fronteira, então nenhum gap de primo ou de twin se perde ou se repete.
+// No modo Twins só addTwinPair() é chamado e as somas de primos ficam zeradas.
+struct ScanAccumulator {
+    // Primos
+    uint64_t firstPrime = 0;
+    uint64_t lastPrime = 0;
+    uint64_t primeCount = 0;
+    ExactSum sumPrimeGaps = 0;
+
+    // Twins
+    uint64_t firstTwinP = 0;
+    int firstTwinClass = -1;
+    uint64_t lastTwinP = 0;
+    int lastTwinClass = -1;
+    uint64_t twinCount = 0;
+    ExactSum sumTwinGaps = 0;
+    ExactSum sumTwinExcess = 0;
+
+    // Regime assintótico (p > 100k)
+    uint64_t asymptoticCount = 0;
+    ExactSum sumAsymptoticExcess = 0;
+
+    // v₂ stats
+    ExactSum sumV2 = 0;
+    uint64_t countV2 = 0;
+    uint64_t v2Histogram[8] = {0};
+
+    // v₂(gap) stats
+    ExactSum sumV2Gap = 0;
+    uint64_t countV2Gap = 0;
+    uint64_t v2GapHistogram[8] = {0};
+
+    // Correlação v₂(p+1) vs v₂(gap), na amostra de transições de twins
+    ExactSum sumV2Twin = 0;
+    ExactSum sumV2Product = 0;
+    ExactSum sumV2Sq = 0;
+    ExactSum sumV2GapSq = 0;
+
+    // Transições mod 30
+    TransitionStats transitions;
+
+    // Gaps máximos
+    GapRecords primeGapRecords;
+    GapRecords twinGapRecords;
+
+    // Bins logarítmicos do kT local (cresce até o bin do último twin)
+    const LogBinLayout *binLayout = &LogBinLayout::standard();
+    std::vector<LogBin> bins;
+
+    // false (modo Primes): addPrime, addSegment e merge não procuram twins,
+    // e nada do lado twin é atualizado. Não vai para o checkpoint.
+    bool trackTwins = true;
+
+    ScanAccumulator() = default;
+    explicit ScanAccumulator(const LogBinLayout &layout) : binLayout(&layout) {}
+
+    void addPrime(uint64_t n)
+    {
+        ++primeCount;
+
+        // v₂(p+1)
+        unsigned k = v2_of(n + 1);
+        sumV2 += k;
+        ++countV2;
+        if (k >= 1 && k <= 7)
+            v2Histogram[k - 1]++;
+        else if (k >= 8)
+            v2Histogram[7]++;
+
+        // Gap de primos
+        if (lastPrime != 0) {
+            uint64_t gap = n - lastPrime;
+            sumPrimeGaps += gap;
+            primeGapRecords.add(lastPrime, gap);
+
+            // Twin?
+            if (gap == 2 && trackTwins)
+                addTwin(lastPrime);
+        } else {
+            firstPrime = n;
+        }
+        lastPrime = n;
+    }
+
+    // Segmento atual do PrimeSieve inteiro, lido palavra a palavra do bitmap:
+    // o mesmo que addPrime em cada primo, sem o desvio por gap == 2. Os primos
+    // saem por ctz/blsr, v₂(p+1) é um ctz com o histograma indexado por
+    // min(v₂, 8) e a soma dos gaps é telescópica. Os twins vêm num segundo
+    // laço, da máscara PrimeSieve::twinWord, com a classe mod 30 dada pela
+    // posição na wheel; sem trackTwins esse laço não roda. twins != nullptr
+    // recebe o p de cada twin, em ordem.
+    void addSegment(const PrimeSieve &sieve, std::vector<uint64_t> *twins)
+    {
+        const uint64_t *words = sieve.words();
+        const uint64_t numWords = sieve.wordCount();
+        uint64_t w0 = 0;
+        while (w0 < numWords && words[w0] == 0) ++w0;
+        if (w0 == numWords) return;
+
+        // Costura com o que veio antes: o twin que atravessa a fronteira
+        const uint64_t first = sieve.valueAt(w0 * 64 + __builtin_ctzll(words[w0]));
+        if (lastPrime != 0) {
+            if (first - lastPrime == 2 && trackTwins) {
+                addTwin(lastPrime);
+                if (twins) twins->push_back(lastPrime);
+            }
+        } else {
+            firstPrime = first;
+        }
+
+        const uint64_t origin = lastPrime != 0 ? lastPrime : first;
+        uint64_t prev = origin, count = 0, v2Sum = 0;
+        uint64_t histogram[8] = {0};
+        for (uint64_t w = w0; w < numWords; ++w) {
+            uint64_t bits = words[w];
+            count += __builtin_popcountll(bits);
+            while (bits) {
+                const uint64_t p = sieve.valueAt(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+                const unsigned k = __builtin_ctzll(p + 1);   // p ímpar: k ≥ 1
+                v2Sum += k;
+                ++histogram[std::min(k, 8u) - 1];
+                primeGapRecords.add(prev, p - prev);         // gap 0 no primeiro: nada
+                prev = p;
+            }
+        }
+        primeCount += count;
+        sumPrimeGaps += prev - origin;
+        sumV2 += v2Sum;
+        countV2 += count;
+        for (int i = 0; i < 8; ++i) v2Histogram[i] += histogram[i];
+        lastPrime = prev;
+        if (!trackTwins) return;
+
+        for (uint64_t w = w0; w < numWords; ++w) {
+            uint64_t bits = sieve.twinWord(w);
+            while (bits) {
+                const uint64_t pos = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                const uint64_t p = sieve.valueAt(pos);
+                addTwin(p, PrimeSieve::twinClassAt(pos));
+                if (twins) twins->push_back(p);
+            }
+        }
+    }
+
+    // Twin (p, p+2) vindo direto do TwinSieve, sem passar pelos primos
+    void addTwinPair(uint64_t p)
+    {
+        addTwin(p);
+    }
+
+    // Maior n já coberto pelo acumulador (último primo ou p+2 do último twin)
+    uint64_t lastN() const
+    {
+        return std::max(lastPrime, lastTwinP != 0 ? lastTwinP + 2 : 0);
+    }
+
+    // Anexa um acumulador do trecho imediatamente seguinte (mesmo binLayout)
+    void merge(const ScanAccumulator &next)
+    {
+        if (next.primeCount == 0 && next.twinCount == 0) return;
+        if (primeCount == 0 && twinCount == 0) { *this = next; return; }
+
+        // Costura: gap (e possível twin) entre os dois trechos
+        if (primeCount > 0 && next.primeCount > 0) {
+            uint64_t gap = next.firstPrime - lastPrime;
+            sumPrimeGaps += gap;
+            primeGapRecords.add(lastPrime, gap);
+            if (gap == 2 && trackTwins)
+                addTwin(lastPrime);
+        }
+
+        if (next.twinCount > 0) {
+            if (lastTwinP != 0) {
+                linkTwins(lastTwinP, lastTwinClass, next.firstTwinP, next.firstTwinClass);
+            } else {
+                firstTwinP = next.firstTwinP;
+                firstTwinClass = next.firstTwinClass;
+            }
+            lastTwinP = next.lastTwinP;
+            lastTwinClass = next.lastTwinClass;
+        }
+
+        // Depois da costura: os recordes de next competem com tudo antes dele
+        primeGapRecords.merge(next.primeGapRecords);
+        twinGapRecords.merge(next.twinGapRecords);
+
+        if (next.primeCount > 0)
+            lastPrime = next.lastPrime;
+        primeCount += next.primeCount;
+        sumPrimeGaps += next.sumPrimeGaps;
+
+        twinCount += next.twinCount;
+        sumTwinGaps += next.sumTwinGaps;
+        sumTwinExcess += next.sumTwinExcess;
+
+        asymptoticCount += next.asymptoticCount;
+        sumAsymptoticExcess += next.sumAsymptoticExcess;
+
+        sumV2 += next.sumV2;
+        countV2 += next.countV2;
+        sumV2Gap += next.sumV2Gap;
+        countV2Gap += next.countV2Gap;
+        for (int i = 0; i < 8; ++i) {
+            v2Histogram[i] += next.v2Histogram[i];
+            v2GapHistogram[i] += next.v2GapHistogram[i];
+        }
+
+        sumV2Twin += next.sumV2Twin;
+        sumV2Product += next.sumV2Product;
+        sumV2Sq += next.sumV2Sq;
+        sumV2GapSq += next.sumV2GapSq;
+
+        transitions.merge(next.transitions);
+
+        if (next.bins.size() > bins.size())
+            bins.resize(next.bins.size());
+        for (size_t i = 0; i < next.bins.size(); ++i) {
+            bins[i].count += next.bins[i].count;
+            bins[i].sumExcess += next.bins[i].sumExcess;
+        }
+        // O cursor de bin segue o último twin, que agora é o de next
+        m_binLow = next.m_binLow;
+        m_binHigh = next.m_binHigh;
+        m_bin = next.m_bin;
+    }
+
+    // Snapshot das estatísticas com n = último número varrido
+    void fillStats(Stats &stats, uint64_t n) const
+    {
+        using namespace Constants;
+
+        stats.currentN = n;
+        stats.primeCount = primeCount;
+        stats.twinCount = twinCount;
+
+        long double ln_p = std::log(static_cast<long double>(n));
+        long double ln2_p = ln_p * ln_p;
+
+        // Regime
+        if (n < FROZEN_LIMIT) {
+            stats.regime = Regime::Frozen;
+        } else if (n < TRANSITION_LIMIT) {
+            stats.regime = Regime::Transition;
+        } else if (n < PRECISE_LIMIT) {
+            stats.regime = Regime::Asymptotic;
+        } else {
+            stats.regime = Regime::Precise;
+        }
+
+        // kT Primos: kT = ⟨gap⟩ - 2
+        if (primeCount > 1) {
+            stats.avgPrimeGap = meanOf(sumPrimeGaps, primeCount - 1);
+            stats.kTPrimeEmpirical = stats.avgPrimeGap - OFFSET_PRIMES;
+        }
+        stats.kTPrimeTheoretical = static_cast<double>(ln_p) - OFFSET_PRIMES;
+
+        // kT Twins
+        if (twinCount > 1) {
+            uint64_t nTrans = twinCount - 1;
+            stats.avgTwinGap = meanOf(sumTwinGaps, nTrans);
+            stats.kTTwinEmpirical = meanOf(sumTwinExcess, nTrans);
+        }
+
+        stats.asymptoticCount = asymptoticCount;
+        if (asymptoticCount > 10) {
+            stats.kTTwinAsymptotic = meanOf(sumAsymptoticExcess, asymptoticCount);
+        }
+
+        // Modelo CUMULATIVO: kT = 0.7784×ln²(p) - 2.32×ln(p) - 13.9
+        stats.kTTwinTheoretical = static_cast<double>(
+            kT_CUM_LN2 * ln2_p + kT_CUM_LN * ln_p + kT_CUM_C
+        );
+
+        // Razão kT/ln²(p)
+        if (ln2_p > 0 && stats.kTTwinAsymptotic > 0) {
+            stats.kTRatio = stats.kTTwinAsymptotic / static_cast<double>(ln2_p);
+        }
+
+        // v₂(p+1)
+        if (countV2 > 0) {
+            stats.meanV2 = meanOf(sumV2, countV2);
+            for (int i = 0; i < 8; ++i)
+                stats.v2Histogram[i] = v2Histogram[i];
+        }
+
+        // v₂(gap)
+        if (countV2Gap > 0) {
+            stats.meanV2Gap = meanOf(sumV2Gap, countV2Gap);
+            for (int i = 0; i < 8; ++i)
+                stats.v2GapHistogram[i] = v2GapHistogram[i];
+        }
+
+        // Correlação de Pearson entre v₂(p+1) e v₂(gap); as médias são da
+        // mesma amostra (twins que iniciam uma transição) que os produtos
+        if (countV2Gap > 10) {
+            double meanP = meanOf(sumV2Twin, countV2Gap);
+            double meanG = meanOf(sumV2Gap, countV2Gap);
+
+            // r = Cov(X,Y) / sqrt(Var(X) × Var(Y))
+            double cov = meanOf(sumV2Product, countV2Gap) - (meanP * meanG);
+            double varP = meanOf(sumV2Sq, countV2Gap) - (meanP * meanP);
+            double varG = meanOf(sumV2GapSq, countV2Gap) - (meanG * meanG);
+
+            if (varP > 0 && varG > 0) {
+                stats.corrV2 = cov / std::sqrt(varP * varG);
+            }
+        }
+
+        // Transições
+        stats.transitions = transitions;
+        for (int c1 = 0; c1 < 3; ++c1)
+            for (int c2 = 0; c2 < 3; ++c2)
+                stats.boltzmannFit[c1][c2] = transitions.fit(c1, c2);
+        stats.primeGapRecords = primeGapRecords;
+        stats.twinGapRecords = twinGapRecords;
+
+        // R² de Boltzmann: consistência de kT entre transições
+        if (twinCount > 100) {
+            double kT_mean = stats.kTTwinEmpirical;
+            if (kT_mean > 0) {
+                double ssRes = 0, ssTot = 0;
+                int validCount = 0;
+
+                for (int c1 = 0; c1 < 3; ++c1) {
+                    for (int c2 = 0; c2 < 3; ++c2) {
+                        if (transitions.count[c1][c2] < 10) continue;
+                        double avgGap = transitions.avgGap(c1, c2);
+                        int gapMin = GAP_MIN[c1][c2];
+                        double kT_trans = avgGap - gapMin;
+
+                        ssRes += (kT_trans - kT_mean) * (kT_trans - kT_mean);
+                        ssTot += kT_trans * kT_trans;
+                        ++validCount;
+                    }
+                }
+
+                if (validCount > 1 && ssTot > 0) {
+                    stats.boltzmannR2 = 1.0 - ssRes / ssTot;
+                }
+            }
+        }
+
+        // Décadas
+        stats.binLayout = binLayout;
+        stats.bins = bins;
+    }
+
+    // Visita todos os campos, na ordem do arquivo de checkpoint
+    template <class IO>
+    void serialize(IO &io)
+    {
+        io(firstPrime); io(lastPrime); io(primeCount); io(sumPrimeGaps);
+        io(firstTwinP); io(firstTwinClass); io(lastTwinP); io(lastTwinClass);
+        io(twinCount); io(sumTwinGaps); io(sumTwinExcess);
+        io(asymptoticCount); io(sumAsymptoticExcess);
+        io(sumV2); io(countV2); io(v2Histogram);
+        io(sumV2Gap); io(countV2Gap); io(v2GapHistogram);
+        io(sumV2Twin); io(sumV2Product); io(sumV2Sq); io(sumV2GapSq);
+        io(transitions.count); io(transitions.sumGap); io(transitions.excessHistogram);
+        primeGapRecords.serialize(io);
+        twinGapRecords.serialize(io);
+        if (!io.ok) return;
+
+        uint64_t perDecade = binLayout->binsPerDecade(), nBins = bins.size();
+        io(perDecade); io(nBins);
+        if (perDecade < 1 || perDecade > LogBinLayout::MAX_BINS_PER_DECADE) {
+            io.ok = false;
+            return;
+        }
+        binLayout = &LogBinLayout::get(static_cast<int>(perDecade));
+        if (nBins > static_cast<uint64_t>(binLayout->size())) {
+            io.ok = false;
+            return;
+        }
+        bins.resize(nBins);
+        for (LogBin &b : bins) {
+            io(b.count); io(b.sumExcess);
+        }
+        m_binLow = m_binHigh = 0;
+    }
+
+private:
+    // Move o cursor para o bin de p (busca binária nas fronteiras)
+    void locateBin(uint64_t p)
+    {
+        m_bin = binLayout->find(p);
+        if (m_bin < 0) {
+            m_binLow = 0;
+            m_binHigh = binLayout->lower(0);
+            return;
+        }
+        m_binLow = binLayout->lower(m_bin);
+        m_binHigh = binLayout->upper(m_bin);
+        if (bins.size() <= static_cast<size_t>(m_bin))
+            bins.resize(m_bin + 1);
+    }
+
+    // Cursor de bin: [m_binLow, m_binHigh) é o bin m_bin (-1 abaixo de 10³)
+    uint64_t m_binLow = 0;
+    uint64_t m_binHigh = 0;
+    int m_bin = -1;
+
+    void addTwin(uint64_t twinP) { addTwin(twinP, classIndex(twinP)); }
+
+    void addTwin(uint64_t twinP, int twinClass)
+    {
+        if (twinClass < 0) return;
+
+        ++twinCount;
+        if (lastTwinP != 0 && lastTwinClass >= 0) {
+            linkTwins(lastTwinP, lastTwinClass, twinP, twinClass);
+        } else {
+            firstTwinP = twinP;
+            firstTwinClass = twinClass;
+        }
+        lastTwinP = twinP;
+        lastTwinClass = twinClass;
+    }
+
+    // Estatísticas do par de twins consecutivos prevP → twinP
+    void linkTwins(uint64_t prevP, int prevClass, uint64_t twinP, int twinClass)
+    {
+        uint64_t twinGap = twinP - prevP;
+        int gapMin = Constants::GAP_MIN[prevClass][twinClass];
+        uint64_t excess = twinGap - gapMin;   // gapMin é o menor gap da transição
+
+        sumTwinGaps += twinGap;
+        sumTwinExcess += excess;
+        twinGapRecords.add(prevP, twinGap);
+
+        // v₂(gap) - trailing zeros do gap
+        unsigned v2_gap = v2_of(twinGap);
+        sumV2Gap += v2_gap;
+        ++countV2Gap;
+
+        if (v2_gap >= 1 && v2_gap <= 7)
+            v2GapHistogram[v2_gap - 1]++;
+        else if (v2_gap >= 8)
+            v2GapHistogram[7]++;
+
+        // Para correlação: usa v₂(p+1) do twin anterior
+        unsigned v2_prev = v2_of(prevP + 1);
+        sumV2Twin += v2_prev;
+        sumV2Product += v2_prev * v2_gap;
+        sumV2Sq += v2_prev * v2_prev;
+        sumV2GapSq += v2_gap * v2_gap;
+
+        // Bin logarítmico de prevP: fora do bin corrente só ao cruzar uma fronteira
+        if (prevP >= m_binHigh || prevP < m_binLow)
+            locateBin(prevP);
+        if (m_bin >= 0) {
+            bins[m_bin].count++;
+            bins[m_bin].sumExcess += excess;
+        }
+
+        // Assintótico (p > 100k)
+        if (prevP > Constants::ASYMPTOTIC_LIMIT) {
+            ++asymptoticCount;
+            sumAsymptoticExcess += excess;
+        }
+
+        // Transições
+        transitions.add(prevClass, twinClass, twinGap);
+    }
+};
+
+// Somas de um trecho contíguo de uma varredura de k-uplas (TupleScanner): o
+// lado twin do ScanAccumulator para um padrão H qualquer, com as classes
+// mod 30 e o gap_min de H. Como lá, merge() costura a transição entre o
+// último p de um trecho e o primeiro do seguinte.
+struct TupleAccumulator {
+    static constexpr int MAX_CLASSES = TupleTables::MAX_CLASSES;
+
+    const TupleTables::Shape *shape = &TwinPattern::S;
+
+    uint64_t firstP = 0;
+    int firstClass = -1;
+    uint64_t lastP = 0;
+    int lastClass = -1;
+    uint64_t count = 0;
+    ExactSum sumGaps = 0;
+    ExactSum sumExcess = 0;
+
+    // Transições entre classes mod 30 (shape->classes)
+    uint64_t transitionCount[MAX_CLASSES][MAX_CLASSES] = {{0}};
+    ExactSum transitionSumGap[MAX_CLASSES][MAX_CLASSES] = {{0}};
+
+    // Bins logarítmicos do kT local, pelo p inicial da transição
+    const LogBinLayout *binLayout = &LogBinLayout::standard();
+    std::vector<LogBin> bins;
+
+    TupleAccumulator() = default;
+    TupleAccumulator(const TupleTables::Shape &s, const LogBinLayout &layout)
+        : shape(&s), binLayout(&layout) {}
+
+    void addTuple(uint64_t p)
+    {
+        const int cls = shape->classOf[p % 30];
+        if (cls < 0) return;
+
+        ++count;
+        if (lastP != 0)
+            link(lastP, lastClass, p, cls);
+        else {
+            firstP = p;
+            firstClass = cls;
+        }
+        lastP = p;
+        lastClass = cls;
+    }
+
+    // Anexa um acumulador do trecho imediatamente seguinte (mesmo padrão e binLayout)
+    void merge(const TupleAccumulator &next)
+    {
+        if (next.count == 0) return;
+        if (count == 0) { *this = next; return; }
+
+        link(lastP, lastClass, next.firstP, next.firstClass);
+        lastP = next.lastP;
+        lastClass = next.lastClass;
+        count += next.count;
+        sumGaps += next.sumGaps;
+        sumExcess += next.sumExcess;
+        for (int i = 0; i < shape->classCount; ++i) {
+            for (int j = 0; j < shape->classCount; ++j) {
+                transitionCount[i][j] += next.transitionCount[i][j];
+                transitionSumGap[i][j] += next.transitionSumGap[i][j];
+            }
+        }
+
+        if (next.bins.size() > bins.size())
+            bins.resize(next.bins.size());
+        for (size_t i = 0; i < next.bins.size(); ++i) {
+            bins[i].count += next.bins[i].count;
+            bins[i].sumExcess += next.bins[i].sumExcess;
+        }
+        m_binLow = next.m_binLow;
+        m_binHigh = next.m_binHigh;
+        m_bin = next.m_bin;
+    }
+
+    uint64_t transitions() const { return count > 1 ? count - 1 : 0; }
+    double avgGap() const { return meanOf(sumGaps, transitions()); }
+    double kT() const { return meanOf(sumExcess, transitions()); }
+    double avgTransitionGap(int i, int j) const { return meanOf(transitionSumGap[i][j], transitionCount[i][j]); }
+
+    // Lei geral: kT_H(p) = (ln p)^k / C_H
+    double kTTheoretical(uint64_t p) const
+    {
+        return static_cast<double>(std::pow(std::log(static_cast<long double>(p)), shape->size)
+                                   / shape->singularSeries);
+    }
+
+    // Década 10^log10 agregada dos bins; aqui sumLn2 acumula ⟨(ln p)^k⟩,
+    // então ratio() é kT/(ln p)^k, cujo valor teórico é 1/C_H
+    DecadeStats decade(int log10) const
+    {
+        DecadeStats d;
+        for (int i = 0; i < static_cast<int>(bins.size()); ++i) {
+            if (binLayout->decade(i) != log10 || bins[i].count == 0) continue;
+            d.count += bins[i].count;
+            d.sumExcess += bins[i].sumExcess;
+            d.sumLn2 += static_cast<long double>(bins[i].count)
+                        * LogBinLayout::meanLnPow(binLayout->lower(i), binLayout->upper(i), shape->size);
+        }
+        return d;
+    }
+
+    int lastDecade() const
+    {
+        return bins.empty() ? LogBinLayout::FIRST_DECADE - 1
+                            : binLayout->decade(static_cast<int>(bins.size()) - 1);
+    }
+
+private:
+    void link(uint64_t prevP, int prevClass, uint64_t p, int cls)
+    {
+        const uint64_t gap = p - prevP;
+        const uint64_t excess = gap - shape->gapMin[prevClass][cls];
+        sumGaps += gap;
+        sumExcess += excess;
+        transitionCount[prevClass][cls]++;
+        transitionSumGap[prevClass][cls] += gap;
+
+        if (prevP >= m_binHigh || prevP < m_binLow) {
+            m_bin = binLayout->find(prevP);
+            m_binLow = m_bin < 0 ? 0 : binLayout->lower(m_bin);
+            m_binHigh = m_bin < 0 ? binLayout->lower(0) : binLayout->upper(m_bin);
+            if (m_bin >= 0 && bins.size() <= static_cast<size_t>(m_bin))
+                bins.resize(m_bin + 1);
+        }
+        if (m_bin >= 0) {
+            bins[m_bin].count++;
+            bins[m_bin].sumExcess += excess;
+        }
+    }
+
+    // Cursor de bin: [m_binLow, m_binHigh) é o bin m_bin (-1 abaixo de 10³)
+    uint64_t m_binLow = 0;
+    uint64_t m_binHigh = 0;
+    int m_bin = -1;
+};
+
+// ======================= CHECKPOINT =======================
+
+// Estado completo de uma varredura: a posição na wheel (primeiro n ainda não
+// varrido; no modo Twins, primeiro p) e o acumulador de tudo antes dela.
+// Como o acumulador guarda lastPrime/lastTwinP, a retomada continua a costura
+// de gaps e twins sem perder nem repetir nada.
+//
+// Formato: campos little-endian de 64 bits, sem padding. ExactSum ocupa duas
+// palavras e long double vai como par de doubles (hi + lo), o que preserva os
+// 64 bits de mantissa do x87. A gravação vai para um temporário que depois
+// substitui o arquivo (rename): um crash no meio da escrita mantém o
+// checkpoint anterior intacto.
+struct ScanCheckpoint {
+    static constexpr uint64_t MAGIC = 0x314B434D52454854ULL;   // "THERMCK1"
+    static constexpr uint64_t VERSION = 4;
+
+    AnalysisMode mode = AnalysisMode::Both;
+    uint64_t startN = 3;          // início original da varredura
+    uint64_t endN = UINT64_MAX;   // último n pedido (inclusive); UINT64_MAX = sem fim
+    uint64_t nextN = 3;           // onde a varredura continua
+    ScanAccumulator acc;
+
+    bool save(const std::string &path, std::string *error = nullptr)
+    {
+        Writer w;
+        serialize(w);
+
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+            file.write(w.bytes.data(), static_cast<std::streamsize>(w.bytes.size()));
+            file.close();
+            if (!file) {
+                if (error) *error = "não foi possível gravar " + tmp;
+                std::remove(tmp.c_str());
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            if (error) *error = ec.message();
+            return false;
+        }
+        return true;
+    }
+
+    bool load(const std::string &path, std::string *error = nullptr)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            if (error) *error = "não foi possível ler " + path;
+            return false;
+        }
+
+        ScanCheckpoint loaded;
+        Reader r{std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>())};
+        loaded.serialize(r);
+        if (!r.ok || r.pos != r.bytes.size()) {
+            if (error) *error = "checkpoint inválido ou de outra versão";
+            return false;
+        }
+        *this = loaded;
+        return true;
+    }
+
+private:
+    struct Writer {
+        std::string bytes;
+        bool ok = true;
+        void operator()(uint64_t &v)
+        {
+            char b[8];
+            for (int i = 0; i < 8; ++i) b[i] = static_cast<char>(v >> (8 * i));
+            bytes.append(b, 8);
+        }
+        void operator()(int &v) { uint64_t u = static_cast<int64_t>(v); (*this)(u); }
+        void operator()(ExactSum &v)
+        {
+            uint64_t lo = static_cast<uint64_t>(v), hi = static_cast<uint64_t>(v >> 64);
+            (*this)(lo); (*this)(hi);
+        }
+        void operator()(long double &v)
+        {
+            double hi = static_cast<double>(v);
+            double lo = static_cast<double>(v - hi);
+            uint64_t a, b;
+            std::memcpy(&a, &hi, 8);
+            std::memcpy(&b, &lo, 8);
+            (*this)(a); (*this)(b);
+        }
+        template <class T, size_t N>
+        void operator()(T (&arr)[N]) { for (T &v : arr) (*this)(v); }
+    };
+
+    struct Reader {
+        std::string bytes;
+        size_t pos = 0;
+        bool ok = true;
+        void operator()(uint64_t &v)
+        {
+            v = 0;
+            if (pos + 8 > bytes.size()) { ok = false; return; }
+            for (int i = 0; i < 8; ++i)
+                v |= uint64_t(static_cast<uint8_t>(bytes[pos + i])) << (8 * i);
+            pos += 8;
+        }
+        void operator()(int &v) { uint64_t u; (*this)(u); v = static_cast<int>(static_cast<int64_t>(u)); }
+        void operator()(ExactSum &v)
+        {
+            uint64_t lo, hi;
+            (*this)(lo); (*this)(hi);
+            v = (ExactSum(hi) << 64) | lo;
+        }
+        void operator()(long double &v)
+        {
+            uint64_t a, b;
+            (*this)(a); (*this)(b);
+            double hi, lo;
+            std::memcpy(&hi, &a, 8);
+            std::memcpy(&lo, &b, 8);
+            v = static_cast<long double>(hi) + lo;
+        }
+        template <class T, size_t N>
+        void operator()(T (&arr)[N]) { for (T &v : arr) (*this)(v); }
+    };
+
+    template <class IO>
+    void serialize(IO &io)
+    {
+        uint64_t magic = MAGIC, version = VERSION;
+        uint64_t modeValue = static_cast<uint64_t>(mode);
+        io(magic); io(version);
+        io(modeValue); io(startN); io(endN); io(nextN);
+        acc.serialize(io);
+        if (magic != MAGIC || version != VERSION || modeValue > uint64_t(AnalysisMode::Both))
+            io.ok = false;
+        mode = static_cast<AnalysisMode>(modeValue);
+    }
+};
+
+// ======================= SNAPSHOT =======================
+
+// Buffer triplo sem locks entre um produtor e um consumidor: publish() nunca
+// espera pelo leitor e take() devolve sempre o valor mais recente, pulando os
+// intermediários. Os três slots reaproveitam a memória (os vectors de Stats).
+template <class T>
+class SnapshotBuffer {
+public:
+    // Thread produtora
+    void publish(const T &value)
+    {
+        m_slots[m_back] = value;
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Thread consumidora: o último valor publicado, ou nullptr se não houve
+    // publicação desde a chamada anterior. Válido até o próximo take().
+    const T *take()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return nullptr;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return &m_slots[m_front];
+    }
+
+private:
+    static constexpr uint8_t INDEX = 3, FRESH = 4;
+    T m_slots[3];
+    uint8_t m_back = 0, m_front = 1;        // donos: produtor e consumidor
+    std::atomic<uint8_t> m_middle{2};       // slot trocado + bit FRESH
+};
+
+// ======================= EXPORTAÇÃO POR TWIN =======================
+
+// Um registro por twin (p, p+2), em colunas, para reanalisar a varredura sem
+// crivar de novo. O arquivo é um cabeçalho seguido de blocos autocontidos:
+//
+//   arquivo: MAGIC (8 bytes) | VERSION (8 bytes) | bloco | bloco | ...
+//   bloco:   firstP (8) | count (4) | reservado (4)
+//            | delta[count] (u32) | gap[count] (u32)
+//            | cls[count] (u8) | v2[count] (u8) | padding até múltiplo de 8
+//
+// delta[i] = p_i − p_{i−1} dentro do bloco (delta[0] = 0, o p do primeiro
+// registro é firstP); gap[i] = p_{i+1} − p_i, o gap até o próximo twin, 0 no
+// último twin de uma varredura encerrada; cls = p mod 30; v2 = v₂(p+1).
+// Os campos vão na ordem de bytes da máquina (x86: little-endian), para que
+// o leitor use as colunas direto do mapeamento.
+struct TwinExportFormat {
+    static constexpr uint64_t MAGIC = 0x31575443524D4854ULL;   // "THMRCTW1"
+    static constexpr uint64_t VERSION = 1;
+    static constexpr size_t FILE_HEADER_BYTES = 16;
+    static constexpr size_t BLOCK_HEADER_BYTES = 16;
+    static constexpr uint32_t BLOCK_RECORDS = 1 << 20;   // ~10 MiB por bloco
+
+    static size_t blockBytes(uint32_t count)
+    {
+        return (BLOCK_HEADER_BYTES + size_t(count) * 10 + 7) / 8 * 8;
+    }
+};
+
+// Leitura sem cópia: mapeia o arquivo e expõe as colunas de cada bloco como
+// ponteiros para dentro do mapeamento. Só lê; o arquivo pode ser reaberto
+// enquanto uma varredura ainda anexa blocos (vê os que existiam no open).
+class TwinExportReader {
+public:
+    struct Block {
+        uint64_t firstP;
+        uint32_t count;
+        const uint32_t *delta;
+        const uint32_t *gap;
+        const uint8_t *cls;
+        const uint8_t *v2;
+    };
+
+    TwinExportReader() = default;
+    TwinExportReader(const TwinExportReader &) = delete;
+    TwinExportReader &operator=(const TwinExportReader &) = delete;
+    ~TwinExportReader() { close(); }
+
+    // tornTail: aceita um bloco truncado no fim (escrita interrompida por
+    // crash, disco cheio ou kill) e indexa só os blocos inteiros antes dele;
+    // sem tornTail esse arquivo é inválido
+    bool open(const std::string &path, std::string *error = nullptr, bool tornTail = false)
+    {
+        close();
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (error) *error = "não foi possível ler " + path;
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            m_size = static_cast<size_t>(st.st_size);
+            void *map = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            m_data = map == MAP_FAILED ? nullptr : static_cast<const uint8_t *>(map);
+        }
+        ::close(fd);
+        if (!m_data || !indexBlocks(tornTail)) {
+            close();
+            if (error) *error = "arquivo de twins inválido ou de outra versão";
+            return false;
+        }
+        // Leitura sequencial de ponta a ponta: readahead agressivo
+        ::madvise(const_cast<uint8_t *>(m_data), m_size, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    void close()
+    {
+        if (m_data) ::munmap(const_cast<uint8_t *>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+        m_blocks.clear();
+        m_records = 0;
+    }
+
+    const std::vector<Block> &blocks() const { return m_blocks; }
+    uint64_t recordCount() const { return m_records; }
+
+    // f(p, cls, v2, gap) para cada registro, em ordem crescente de p
+    template <class F>
+    void forEach(F f) const
+    {
+        for (const Block &b : m_blocks) {
+            uint64_t p = b.firstP;
+            for (uint32_t i = 0; i < b.count; ++i) {
+                p += b.delta[i];
+                f(p, b.cls[i], b.v2[i], b.gap[i]);
+            }
+        }
+    }
+
+private:
+    // Percorre os cabeçalhos; um bloco truncado ou ilegível no fim (escrita
+    // interrompida) encerra o índice com tornTail e invalida o arquivo sem ele
+    bool indexBlocks(bool tornTail)
+    {
+        uint64_t magic, version;
+        if (m_size < TwinExportFormat::FILE_HEADER_BYTES) return false;
+        std::memcpy(&magic, m_data, 8);
+        std::memcpy(&version, m_data + 8, 8);
+        if (magic != TwinExportFormat::MAGIC || version != TwinExportFormat::VERSION)
+            return false;
+
+        size_t pos = TwinExportFormat::FILE_HEADER_BYTES;
+        while (pos < m_size) {
+            if (m_size - pos < TwinExportFormat::BLOCK_HEADER_BYTES) return tornTail;
+            Block b;
+            std::memcpy(&b.firstP, m_data + pos, 8);
+            std::memcpy(&b.count, m_data + pos + 8, 4);
+            // count 0 nunca é gravado: é o fim zerado que alguns sistemas de
+            // arquivos deixam depois de um crash
+            if (b.count == 0 || b.count > TwinExportFormat::BLOCK_RECORDS) return tornTail;
+            const size_t bytes = TwinExportFormat::blockBytes(b.count);
+            if (m_size - pos < bytes) return tornTail;
+            const uint8_t *col = m_data + pos + TwinExportFormat::BLOCK_HEADER_BYTES;
+            b.delta = reinterpret_cast<const uint32_t *>(col);
+            b.gap = b.delta + b.count;
+            b.cls = reinterpret_cast<const uint8_t *>(b.gap + b.count);
+            b.v2 = b.cls + b.count;
+            m_blocks.push_back(b);
+            m_records += b.count;
+            pos += bytes;
+        }
+        return true;
+    }
+
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<Block> m_blocks;
+    uint64_t m_records = 0;
+};
+
+// Gravação só por anexação: os registros se acumulam nas colunas de um bloco
+// em memória, e cada bloco cheio (ou cada flush) vira uma única escrita
+// sequencial. O registro de um twin só sai quando o próximo chega (o gap
+// depende dele); add() precisa receber os p em ordem crescente.
+class TwinExportWriter {
+public:
+    // resumeTwin = 0: arquivo novo. Senão, retoma uma varredura cujo último
+    // twin conhecido é resumeTwin (ScanAccumulator::lastTwinP do checkpoint):
+    // mantém os registros com p < resumeTwin, descarta o que foi gravado
+    // depois do checkpoint e deixa resumeTwin pendente à espera do gap.
+    // Um bloco truncado no fim é sempre posterior ao flush do checkpoint e
+    // sai junto; falha se os blocos inteiros não chegam até resumeTwin.
+    bool open(const std::string &path, uint64_t resumeTwin, std::string *error = nullptr)
+    {
+        if (m_file.is_open()) m_file.close();
+        if (!m_delta) {
+            constexpr uint32_t N = TwinExportFormat::BLOCK_RECORDS;
+            m_delta.reset(new uint32_t[N]);
+            m_gap.reset(new uint32_t[N]);
+            m_cls.reset(new uint8_t[N]);
+            m_v2.reset(new uint8_t[N]);
+        }
+        m_path = path;
+        clearBlock();
+        m_pending = 0;
+
+        std::error_code ec;
+        uint64_t keepBytes = 0;
+        if (resumeTwin != 0 && std::filesystem::exists(path, ec)) {
+            TwinExportReader reader;
+            if (!reader.open(path, error, true)) return false;
+            keepBytes = TwinExportFormat::FILE_HEADER_BYTES;
+            // O último registro mantido aponta (p + gap) para resumeTwin
+            uint64_t lastP = 0, lastGap = 0;
+            for (const TwinExportReader::Block &b : reader.blocks()) {
+                uint64_t p = b.firstP;
+                for (uint32_t i = 0; i < b.count; ++i) {
+                    p += b.delta[i];
+                    if (p >= resumeTwin) break;
+                    push(p, b.gap[i]);
+                    lastP = p;
+                    lastGap = b.gap[i];
+                }
+                if (m_count < b.count) break;
+                // Bloco inteiro antes de resumeTwin: fica no arquivo como está
+                keepBytes += TwinExportFormat::blockBytes(b.count);
+                clearBlock();
+            }
+            if (lastP != 0 && lastP + lastGap != resumeTwin) {
+                if (error) *error = "arquivo de twins não cobre o checkpoint: " + path;
+                return false;
+            }
+        }
+        if (keepBytes == 0) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            const uint64_t header[2] = {TwinExportFormat::MAGIC, TwinExportFormat::VERSION};
+            file.write(reinterpret_cast<const char *>(header), sizeof(header));
+            if (!file) return fail(error);
+        } else {
+            std::filesystem::resize_file(path, keepBytes, ec);
+            if (ec) return fail(error);
+        }
+        m_file.open(path, std::ios::binary | std::ios::app);
+        if (!m_file) return fail(error);
+        m_pending = resumeTwin;
+        return true;
+    }
+
+    bool isOpen() const { return m_file.is_open(); }
+
+    // Twin (p, p+2); ignora p já registrados (a costura de uma retomada
+    // pode reapresentar o último twin)
+    void add(uint64_t p)
+    {
+        if (p <= m_pending) return;
+        if (m_pending != 0) {
+            push(m_pending, static_cast<uint32_t>(p - m_pending));
+            if (m_count == TwinExportFormat::BLOCK_RECORDS) writeBlock();
+        }
+        m_pending = p;
+    }
+
+    // Grava o bloco parcial (antes de cada checkpoint): tudo o que precede o
+    // twin pendente fica no disco
+    bool flush(std::string *error = nullptr)
+    {
+        writeBlock();
+        m_file.flush();
+        return m_file ? true : fail(error);
+    }
+
+    // Fim da varredura: o último twin sai com gap 0 (próximo desconhecido)
+    bool close(std::string *error = nullptr)
+    {
+        if (!m_file.is_open()) return true;
+        if (m_pending != 0) push(m_pending, 0);
+        m_pending = 0;
+        const bool ok = flush(error);
+        m_file.close();
+        return ok;
+    }
+
+private:
+    void push(uint64_t p, uint32_t gap)
+    {
+        if (m_count == 0) {
+            m_firstP = p;
+            m_lastP = p;
+        }
+        m_delta[m_count] = static_cast<uint32_t>(p - m_lastP);
+        m_gap[m_count] = gap;
+        m_cls[m_count] = static_cast<uint8_t>(p % 30);
+        m_v2[m_count] = static_cast<uint8_t>(v2_of(p + 1));
+        m_lastP = p;
+        ++m_count;
+    }
+
+    void clearBlock() { m_count = 0; }
+
+    // Cabeçalho e colunas em sequência: poucas escritas grandes por bloco
+    void writeBlock()
+    {
+        if (m_count == 0) return;
+        uint8_t header[TwinExportFormat::BLOCK_HEADER_BYTES] = {};
+        std::memcpy(header, &m_firstP, 8);
+        std::memcpy(header + 8, &m_count, 4);
+        const uint64_t zero = 0;
+        const size_t padding = TwinExportFormat::blockBytes(m_count)
+                               - TwinExportFormat::BLOCK_HEADER_BYTES - size_t(m_count) * 10;
+        auto put = [this](const void *data, size_t bytes) {
+            m_file.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        };
+        put(header, sizeof(header));
+        put(m_delta.get(), m_count * 4u);
+        put(m_gap.get(), m_count * 4u);
+        put(m_cls.get(), m_count);
+        put(m_v2.get(), m_count);
+        put(&zero, padding);
+        clearBlock();
+    }
+
+    bool fail(std::string *error)
+    {
+        if (error) *error = "não foi possível gravar " + m_path;
+        return false;
+    }
+
+    // Colunas do bloco em formação, alocadas no primeiro open()
+    std::unique_ptr<uint32_t[]> m_delta;
+    std::unique_ptr<uint32_t[]> m_gap;
+    std::unique_ptr<uint8_t[]> m_cls;
+    std::unique_ptr<uint8_t[]> m_v2;
+    uint32_t m_count = 0;
+    uint64_t m_firstP = 0;
+    uint64_t m_lastP = 0;
+    uint64_t m_pending = 0;
+    std::ofstream m_file;
+    std::string m_path;
+};
+
+// ======================= TESTE NO WHEEL MOD 30030 =======================
+
+// Janelas estreitas em magnitude alta não pagam o crivo: só ativar os π(√hi)
+// primos de crivo custa mais do que testar cada candidato do wheel (10⁶
+// números a partir de 10¹⁸ levam 6,6 s pelo crivo e 0,13 s por teste). A troca
+// compensa enquanto hi − lo < √hi / ln √hi.
+inline bool preferWheelTest(uint64_t lo, uint64_t hi)
+{
+    if (lo < 30030 || hi <= lo) return false;
+    const double root = std::sqrt(static_cast<double>(hi));
+    return static_cast<double>(hi - lo) < root / std::log(root);
+}
+
+// Caminho por teste com o mesmo protocolo dos crivos (nextSegment + forEach),
+// em blocos de SPAN números. Usa o maior wheel gerado: o Miller-Rabin domina o
+// custo, e mod 30030 ganha ~10% sobre mod 210 em primos e ~25% em twins, cujos
+// pares candidatos (passo 2 no wheel) caem de 7,1% para 4,9% dos números.
+class WheelTestSieve {
+public:
+    using Wheel = WheelIteratorMod<30030>;
+    static constexpr uint64_t SPAN = 1 << 16;
+
+    // twins = false: primos de [lo, hi]; true: p com lo ≤ p e p+2 ≤ hi
+    WheelTestSieve(uint64_t lo, uint64_t hi, bool twins)
+        : m_it(lo), m_hi(hi), m_twins(twins),
+          m_done(lo > hi || m_it.current() < lo)   // sem candidato abaixo de 2⁶⁴
+    {
+    }
+
+    // Vazio até reset
+    explicit WheelTestSieve(bool twins) : WheelTestSieve(1, 0, twins) {}
+
+    // Como PrimeSieve::reset e TwinSieve::reset: limit exclusivo para o
+    // primo, ou para o p do twin
+    void reset(uint64_t lo, uint64_t limit)
+    {
+        if (lo >= limit) *this = WheelTestSieve(1, 0, m_twins);
+        else if (!m_twins) *this = WheelTestSieve(lo, limit - 1, false);
+        else *this = WheelTestSieve(lo, limit == UINT64_MAX ? UINT64_MAX : limit + 1, true);
+    }
+
+    // Fim exclusivo do que o bloco atual cobre, na mesma régua de reset:
+    // primos até o último candidato, p de twins até dois antes dele
+    uint64_t segmentHigh() const { return m_high; }
+
+    // Candidatos do wheel testados no bloco atual
+    uint64_t segmentCandidates() const { return m_candidates; }
+
+    bool twins() const { return m_twins; }
+
+    bool nextSegment()
+    {
+        m_hits.clear();
+        m_candidates = 0;
+        const uint64_t first = m_it.current();
+        if (m_done || first > m_hi) return false;
+        const uint64_t end = hiOfBlock(first);
+        m_high = end == UINT64_MAX ? UINT64_MAX
+               : m_twins ? std::max(first, end - 1) : end + 1;
+        for (;;) {
+            const uint64_t n = m_it.current();
+            if (n > end) break;
+            ++m_candidates;
+            if (!m_twins) {
+                if (MillerRabin::isPrimeFromWheel(n)) m_hits.push_back(n);
+            } else if (n - m_prev == 2 && MillerRabin::isPrimeFromWheel(m_prev)
+                       && MillerRabin::isPrimeFromWheel(n)) {
+                m_hits.push_back(m_prev);
+            }
+            m_prev = n;
+            m_it.next();
+            if (m_it.current() < n) {   // passou de 2⁶⁴
+                m_done = true;
+                return true;
+            }
+        }
+        m_done = m_it.current() > m_hi;
+        return true;
+    }
+
+    template <class F>
+    void forEach(F f) const
+    {
+        for (uint64_t q : m_hits) f(q);
+    }
+
+private:
+    uint64_t hiOfBlock(uint64_t first) const
+    {
+        return m_hi - first < SPAN ? m_hi : first + SPAN - 1;
+    }
+
+    Wheel m_it;
+    uint64_t m_hi;
+    uint64_t m_prev = 0;
+    uint64_t m_high = 0;
+    uint64_t m_candidates = 0;
+    bool m_twins;
+    bool m_done;
+    std::vector<uint64_t> m_hits;
+};
+
+// ======================= VARREDURA =======================
+
+// Varredura de [início, fim] com as estatísticas de ScanAccumulator, em série
+// ou em blocos paralelos, com checkpoints opcionais. Os resultados saem pelo
+// callback de progresso (na thread que chama run()); result() tem o
+// acumulador final. stop() pode ser chamado de qualquer thread.
+//
+// Como em forEachPrime, intervalos em que preferWheelTest vale vão pelo
+// WheelTestSieve (addPrime ou addTwinPair por número, blocos paralelos de
+// WHEEL_TEST_CHUNK); os demais, pelo PrimeSieve ou TwinSieve.
+class Scanner
+{
+public:
+    // Tamanho do bloco distribuído a cada thread (múltiplo de 840 para
+    // que os segmentos de todos os blocos fiquem alinhados)
+    static constexpr uint64_t PARALLEL_CHUNK = 64 * PrimeSieve::SEGMENT_CYCLES * 210;
+    // Bloco do caminho por teste: o intervalo inteiro cabe em poucos
+    // PARALLEL_CHUNK, e cada número custa um Miller-Rabin
+    static constexpr uint64_t WHEEL_TEST_CHUNK = 16 * WheelTestSieve::SPAN;
+
+    using ProgressCallback = std::function<void(const Stats &)>;
+    using ErrorCallback = std::function<void(const std::string &)>;
+
+    Scanner()
+    {
+        m_stopRequested.store(false);
+    }
+
+    // endN: último n varrido (inclusive); UINT64_MAX = até o Stop
+    void configure(uint64_t startN, AnalysisMode mode, bool multiThread,
+                   uint64_t endN = UINT64_MAX)
+    {
+        m_startN = std::max(startN, uint64_t(3));
+        m_originN = m_startN;
+        m_mode = mode;
+        m_multiThread = multiThread;
+        m_limitN = endN == UINT64_MAX ? UINT64_MAX : endN + 1;
+        m_initial = ScanAccumulator(*m_binLayout);
+        m_resumeTwin = 0;
+        m_stopRequested.store(false);
+    }
+
+    // Continua a varredura salva em ckpt (no lugar de configure)
+    void resume(const ScanCheckpoint &ckpt, bool multiThread)
+    {
+        configure(ckpt.startN, ckpt.mode, multiThread, ckpt.endN);
+        m_startN = std::max(ckpt.nextN, m_startN);
+        m_initial = ckpt.acc;
+        m_binLayout = ckpt.acc.binLayout;
+        m_resumeTwin = ckpt.acc.lastTwinP;
+    }
+
+    // Resolução dos bins logarítmicos do kT local; chamar antes de configure
+    void setBinsPerDecade(int binsPerDecade)
+    {
+        m_binLayout = &LogBinLayout::get(binsPerDecade);
+    }
+
+    // Número de threads do modo multi-thread (0 = uma por núcleo)
+    void setThreadCount(unsigned n) { m_threadCount = n; }
+
+    // Grava um checkpoint em path a cada intervalSec segundos, no Stop e no
+    // fim da varredura; path vazio desliga
+    void setCheckpointFile(const std::string &path, int intervalSec = 60)
+    {
+        m_checkpointPath = path;
+        m_checkpointInterval = std::chrono::seconds(intervalSec);
+    }
+
+    // Grava um registro por twin em path (ver TwinExportWriter); numa
+    // retomada, continua o arquivo do ponto do checkpoint. Vazio desliga.
+    void setTwinExportFile(const std::string &path) { m_exportPath = path; }
+
+    // Bitmaps de primos já crivados (modos Primes e Both; o crivo de pares
+    // tem outro layout, e o caminho por teste não crivam). O cache é compartilhado pelas threads e precisa
+    // viver até o fim de run(); nullptr desliga.
+    void setSegmentCache(SegmentCache *cache) { m_cache = cache; }
+
+    // Stats a cada segmento do crivo (a cada bloco no modo multi-thread);
+    // falhas ao gravar checkpoint ou a exportação de twins
+    void setProgressCallback(ProgressCallback cb) { m_onProgress = std::move(cb); }
+    void setCheckpointErrorCallback(ErrorCallback cb) { m_onCheckpointError = std::move(cb); }
+    void setExportErrorCallback(ErrorCallback cb) { m_onExportError = std::move(cb); }
+
+    // Executa a varredura; retorna no fim do intervalo ou após stop()
+    void run()
+    {
+        m_lastCheckpoint = std::chrono::steady_clock::now();
+        std::string error;
+        if (!m_exportPath.empty() && !m_export.open(m_exportPath, m_resumeTwin, &error))
+            exportFailed(error);
+        m_wheelTest = m_startN < m_limitN && preferWheelTest(m_startN, m_limitN - 1);
+        // No modo Primes os twins só interessam à exportação
+        m_initial.trackTwins = m_mode != AnalysisMode::Primes || m_export.isOpen();
+
+        // Uma varredura já concluída (retomada) só reporta o checkpoint
+        if (m_multiThread && threadCount() > 1 && m_startN < m_limitN)
+            processParallel();
+        else
+            processSequential();
+
+        if (m_export.isOpen() && !m_export.close(&error))
+            exportFailed(error);
+    }
+
+    void stop() { m_stopRequested.store(true); }
+
+    // Acumulador de tudo o que foi varrido (inclui o herdado do checkpoint)
+    const ScanAccumulator &result() const { return m_result; }
+
+private:
+    // Stats de acc pelo callback; nada antes do primeiro primo ou twin
+    void report(const ScanAccumulator &acc, Stats &stats)
+    {
+        if (!m_onProgress || (acc.primeCount == 0 && acc.twinCount == 0)) return;
+        Profile::PhaseTimer timer(Profile::REPORT);
+        acc.fillStats(stats, acc.lastN());
+        m_onProgress(stats);
+        Profile::add(Profile::REPORTS);
+    }
+
+    unsigned threadCount() const
+    {
+        return m_threadCount > 0 ? m_threadCount
+                                 : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // No modo Twins o TwinSieve percorre só os pares e o limite vale para p:
+    // p + 2 < m_limitN. Nos outros modos o PrimeSieve enumera todos os primos.
+    uint64_t twinLimit() const
+    {
+        return m_limitN == UINT64_MAX ? UINT64_MAX : m_limitN - 2;
+    }
+
+    // Salva acc, que cobre tudo antes de nextN; sem force, respeita o intervalo
+    void checkpoint(const ScanAccumulator &acc, uint64_t nextN, bool force)
+    {
+        if (m_checkpointPath.empty()) return;
+        const auto now = std::chrono::steady_clock::now();
+        if (!force && now - m_lastCheckpoint < m_checkpointInterval) return;
+        m_lastCheckpoint = now;
+        Profile::PhaseTimer timer(Profile::CHECKPOINT);
+
+        // O arquivo de twins precisa cobrir o checkpoint: a retomada corta
+        // nele tudo a partir de acc.lastTwinP
+        std::string exportError;
+        if (m_export.isOpen() && !m_export.flush(&exportError))
+            exportFailed(exportError);
+
+        ScanCheckpoint ckpt;
+        ckpt.mode = m_mode;
+        ckpt.startN = m_originN;
+        ckpt.endN = m_limitN == UINT64_MAX ? UINT64_MAX : m_limitN - 1;
+        ckpt.nextN = nextN;
+        ckpt.acc = acc;
+        std::string error;
+        if (!ckpt.save(m_checkpointPath, &error) && m_onCheckpointError)
+            m_onCheckpointError(error);
+    }
+
+    // twins != nullptr (exportação ligada): anota também o p de cada twin
+    // fechado no segmento, em ordem
+    static void scanSegment(const PrimeSieve &sieve, ScanAccumulator &acc,
+                            std::vector<uint64_t> *twins)
+    {
+        acc.addSegment(sieve, twins);
+    }
+
+    static void scanSegment(const TwinSieve &sieve, ScanAccumulator &acc,
+                            std::vector<uint64_t> *twins)
+    {
+        if (!twins) {
+            sieve.forEachTuple([&](uint64_t p) { acc.addTwinPair(p); });
+            return;
+        }
+        sieve.forEachTuple([&](uint64_t p) {
+            twins->push_back(p);
+            acc.addTwinPair(p);
+        });
+    }
+
+    // Bloco do caminho por teste: os primos um a um (o twin sai do gap), ou
+    // os twins prontos
+    static void scanSegment(const WheelTestSieve &sieve, ScanAccumulator &acc,
+                            std::vector<uint64_t> *twins)
+    {
+        if (sieve.twins()) {
+            sieve.forEach([&](uint64_t p) {
+                if (twins) twins->push_back(p);
+                acc.addTwinPair(p);
+            });
+            return;
+        }
+        sieve.forEach([&](uint64_t p) {
+            if (twins && acc.lastPrime != 0 && p - acc.lastPrime == 2)
+                twins->push_back(acc.lastPrime);
+            acc.addPrime(p);
+        });
+    }
+
+    // Um segmento: crivo, enumeração e contadores, cada fase no seu cronômetro;
+    // false quando o crivo acabou
+    template <class Sieve>
+    static bool sieveAndScan(Sieve &sieve, ScanAccumulator &acc, std::vector<uint64_t> *twins)
+    {
+        {
+            Profile::PhaseTimer timer(Profile::SIEVE);
+            if (!sieve.nextSegment()) return false;
+        }
+        Profile::PhaseTimer timer(Profile::ACCUMULATE);
+        const uint64_t primes = acc.primeCount, pairs = acc.twinCount;
+        scanSegment(sieve, acc, twins);
+        Profile::add(Profile::SEGMENTS);
+        Profile::add(Profile::CANDIDATES, sieve.segmentCandidates());
+        Profile::add(Profile::PRIMES, acc.primeCount - primes);
+        Profile::add(Profile::TWINS, acc.twinCount - pairs);
+        return true;
+    }
+
+    void exportTwins(std::vector<uint64_t> &twins)
+    {
+        for (uint64_t p : twins) m_export.add(p);
+        twins.clear();
+    }
+
+    void exportFailed(const std::string &error)
+    {
+        if (m_onExportError) m_onExportError(error);
+    }
+
+    void processSequential()
+    {
+        ScanAccumulator acc = m_initial;
+        Stats stats;
+        uint64_t nextN = m_startN;
+        std::vector<uint64_t> twins;
+        std::vector<uint64_t> *exported = m_export.isOpen() ? &twins : nullptr;
+
+        // Um segmento do crivo por iteração; progresso, stop e checkpoints
+        // ficam entre segmentos, onde acc cobre exatamente [início, segmentHigh)
+        auto scan = [&](auto &sieve) {
+            while (!m_stopRequested.load() && sieveAndScan(sieve, acc, exported)) {
+                exportTwins(twins);
+                nextN = sieve.segmentHigh();
+                report(acc, stats);
+                checkpoint(acc, nextN, false);
+            }
+        };
+        if (m_wheelTest) {
+            WheelTestSieve sieve(m_mode == AnalysisMode::Twins);
+            sieve.reset(m_startN, m_mode == AnalysisMode::Twins ? twinLimit() : m_limitN);
+            scan(sieve);
+        } else if (m_mode == AnalysisMode::Twins) {
+            TwinSieve sieve(m_startN, twinLimit());
+            scan(sieve);
+        } else {
+            PrimeSieve sieve(m_startN, m_limitN);
+            sieve.setCache(m_cache);
+            scan(sieve);
+        }
+        if (!m_stopRequested.load())
+            nextN = std::max(nextN, m_limitN);
+        checkpoint(acc, nextN, true);
+
+        // Uma retomada sem nada novo a varrer ainda reporta o checkpoint
+        if (nextN == m_startN)
+            report(acc, stats);
+        m_result = std::move(acc);
+    }
+
+    // Divide a varredura em blocos de PARALLEL_CHUNK números (WHEEL_TEST_CHUNK
+    // no caminho por teste) distribuídos entre as threads; cada bloco gera um
+    // ScanAccumulator parcial e esta thread os combina em ordem, emitindo o
+    // progresso a cada bloco.
+    void processParallel()
+    {
+        if (m_startN >= m_limitN) return;
+
+        const unsigned nThreads = threadCount();
+        const uint64_t chunkSize = m_wheelTest ? WHEEL_TEST_CHUNK : PARALLEL_CHUNK;
+        // Saturado: perto de 2⁶⁴ o fim do primeiro bloco daria a volta
+        const uint64_t firstChunk = m_startN / chunkSize + 1;
+        const uint64_t firstChunkEnd = firstChunk > UINT64_MAX / chunkSize
+            ? UINT64_MAX : firstChunk * chunkSize;
+        auto chunkStart = [&](uint64_t idx) -> uint64_t {
+            if (idx == 0) return m_startN;
+            uint64_t off = (idx - 1) * chunkSize;
+            if (firstChunkEnd >= m_limitN || off >= m_limitN - firstChunkEnd)
+                return m_limitN;
+            return firstChunkEnd + off;
+        };
+
+        // Bloco pronto: o acumulador e, com exportação, os twins internos a ele
+        struct ChunkResult {
+            ScanAccumulator acc;
+            std::vector<uint64_t> twins;
+        };
+        const bool exporting = m_export.isOpen();
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::map<uint64_t, ChunkResult> done;
+        uint64_t nextToMerge = 0;
+        std::atomic<uint64_t> nextChunk{0};
+        // Limita os blocos prontos e ainda não combinados
+        const uint64_t window = 2 * uint64_t(nThreads);
+
+        auto work = [&](auto &sieve, uint64_t limit) {
+            for (;;) {
+                const uint64_t idx = nextChunk.fetch_add(1);
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] {
+                        return idx < nextToMerge + window || m_stopRequested.load();
+                    });
+                }
+                const uint64_t lo = chunkStart(idx), hi = chunkStart(idx + 1);
+                if (m_stopRequested.load() || lo >= hi) return;
+
+                ChunkResult chunk{ScanAccumulator(*m_binLayout), {}};
+                chunk.acc.trackTwins = m_initial.trackTwins;
+                sieve.reset(lo, std::min(hi, limit));
+                while (sieveAndScan(sieve, chunk.acc, exporting ? &chunk.twins : nullptr)) {
+                    if (m_stopRequested.load()) return;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                done.emplace(idx, std::move(chunk));
+                cv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < nThreads; ++i) {
+            threads.emplace_back([&] {
+                if (m_wheelTest) {
+                    WheelTestSieve sieve(m_mode == AnalysisMode::Twins);
+                    work(sieve, m_mode == AnalysisMode::Twins ? twinLimit() : m_limitN);
+                } else if (m_mode == AnalysisMode::Twins) {
+                    TwinSieve sieve;
+                    work(sieve, twinLimit());
+                } else {
+                    PrimeSieve sieve;
+                    sieve.setCache(m_cache);
+                    work(sieve, m_limitN);
+                }
+            });
+        }
+
+        ScanAccumulator total = m_initial;
+        Stats stats;
+        uint64_t nextN = m_startN;
+        for (;;) {
+            ChunkResult part;
+            uint64_t end;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                // Espera com timeout: stop() só altera a flag atômica
+                while (!done.count(nextToMerge) && !m_stopRequested.load())
+                    cv.wait_for(lock, std::chrono::milliseconds(100));
+                if (m_stopRequested.load()) break;
+
+                auto it = done.find(nextToMerge);
+                part = std::move(it->second);
+                done.erase(it);
+                end = chunkStart(nextToMerge + 1);
+                ++nextToMerge;
+                cv.notify_all();
+            }
+
+            {
+                Profile::PhaseTimer timer(Profile::MERGE);
+                if (exporting) {
+                    // O twin que atravessa a fronteira só aparece na costura
+                    if (total.primeCount > 0 && part.acc.primeCount > 0
+                        && part.acc.firstPrime - total.lastPrime == 2)
+                        m_export.add(total.lastPrime);
+                    exportTwins(part.twins);
+                }
+                // O twin costurado na fronteira não passou por nenhum bloco
+                const uint64_t twins = total.twinCount + part.acc.twinCount;
+                total.merge(part.acc);
+                Profile::add(Profile::TWINS, total.twinCount - twins);
+            }
+            nextN = end;
+            report(total, stats);
+            if (end == m_limitN) break;
+            checkpoint(total, nextN, false);
+        }
+        checkpoint(total, nextN, true);
+
+        m_stopRequested.store(true);
+        cv.notify_all();
+        for (auto &t : threads) t.join();
+        m_result = std::move(total);
+    }
+
+    std::atomic<bool> m_stopRequested;
+    uint64_t m_startN = 3;            // onde esta execução começa
+    uint64_t m_originN = 3;           // início da varredura (≠ m_startN ao retomar)
+    uint64_t m_limitN = UINT64_MAX;   // exclusivo
+    AnalysisMode m_mode = AnalysisMode::Both;
+    bool m_multiThread = false;
+    bool m_wheelTest = false;         // preferWheelTest no intervalo desta execução
+    unsigned m_threadCount = 0;
+    ScanAccumulator m_initial;        // estado herdado do checkpoint
+    const LogBinLayout *m_binLayout = &LogBinLayout::standard();
+
+    std::string m_checkpointPath;
+    std::chrono::seconds m_checkpointInterval{60};
+    std::chrono::steady_clock::time_point m_lastCheckpoint;
+
+    SegmentCache *m_cache = nullptr;
+
+    std::string m_exportPath;
+    TwinExportWriter m_export;
+    uint64_t m_resumeTwin = 0;        // último twin do checkpoint (0 = arquivo novo)
+
+    ProgressCallback m_onProgress;
+    ErrorCallback m_onCheckpointError;
+    ErrorCallback m_onExportError;
+    ScanAccumulator m_result;
+};
+
+// Varredura das k-uplas do padrão Pattern em [início, fim] (k-uplas inteiras
+// no intervalo: p + h_k ≤ fim), nos mesmos blocos de PARALLEL_CHUNK do
+// Scanner, combinados em ordem por esta thread. Sem checkpoints; o progresso
+// sai pelo callback a cada bloco combinado.
+template <class Pattern>
+class TupleScanner
+{
+public:
+    using ProgressCallback = std::function<void(const TupleAccumulator &)>;
+
+    void configure(uint64_t startN, uint64_t endN)
+    {
+        m_startN = std::max<uint64_t>(startN, 11);
+        const uint64_t span = Pattern::S.span;
+        m_limitP = endN >= span ? std::max(endN - span + 1, m_startN) : m_startN;
+        m_stopRequested.store(false);
+    }
+
+    void setBinsPerDecade(int binsPerDecade) { m_binLayout = &LogBinLayout::get(binsPerDecade); }
+    void setThreadCount(unsigned n) { m_threadCount = n; }
+    void setProgressCallback(ProgressCallback cb) { m_onProgress = std::move(cb); }
+
+    void run()
+    {
+        m_result = TupleAccumulator(Pattern::S, *m_binLayout);
+        if (m_startN >= m_limitP) return;
+
+        const unsigned nThreads = m_threadCount > 0 ? m_threadCount
+                                                    : std::max(1u, std::thread::hardware_concurrency());
+        const uint64_t chunk = Scanner::PARALLEL_CHUNK;
+        // Saturado como em Scanner::processParallel
+        const uint64_t firstChunk = m_startN / chunk + 1;
+        const uint64_t firstChunkEnd = firstChunk > UINT64_MAX / chunk ? UINT64_MAX : firstChunk * chunk;
+        auto chunkStart = [&](uint64_t idx) -> uint64_t {
+            if (idx == 0) return m_startN;
+            uint64_t off = (idx - 1) * chunk;
+            if (firstChunkEnd >= m_limitP || off >= m_limitP - firstChunkEnd)
+                return m_limitP;
+            return firstChunkEnd + off;
+        };
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::map<uint64_t, TupleAccumulator> done;
+        uint64_t nextToMerge = 0;
+        std::atomic<uint64_t> nextChunk{0};
+        const uint64_t window = 2 * uint64_t(nThreads);
+
+        auto work = [&] {
+            TupleSieve<Pattern> sieve;
+            for (;;) {
+                const uint64_t idx = nextChunk.fetch_add(1);
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] {
+                        return idx < nextToMerge + window || m_stopRequested.load();
+                    });
+                }
+                const uint64_t lo = chunkStart(idx), hi = chunkStart(idx + 1);
+                if (m_stopRequested.load() || lo >= hi) return;
+
+                TupleAccumulator acc(Pattern::S, *m_binLayout);
+                sieve.reset(lo, hi);
+                while (sieve.nextSegment()) {
+                    if (m_stopRequested.load()) return;
+                    sieve.forEachTuple([&](uint64_t p) { acc.addTuple(p); });
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                done.emplace(idx, std::move(acc));
+                cv.notify_all();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < nThreads; ++i)
+            threads.emplace_back(work);
+
+        for (;;) {
+            TupleAccumulator part;
+            uint64_t end;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!done.count(nextToMerge) && !m_stopRequested.load())
+                    cv.wait_for(lock, std::chrono::milliseconds(100));
+                if (m_stopRequested.load()) break;
+
+                auto it = done.find(nextToMerge);
+                part = std::move(it->second);
+                done.erase(it);
+                end = chunkStart(nextToMerge + 1);
+                ++nextToMerge;
+                cv.notify_all();
+            }
+            m_result.merge(part);
+            if (m_onProgress) m_onProgress(m_result);
+            if (end == m_limitP) break;
+        }
+
+        m_stopRequested.store(true);
+        cv.notify_all();
+        for (auto &t : threads) t.join();
+    }
+
+    void stop() { m_stopRequested.store(true); }
+
+    const TupleAccumulator &result() const { return m_result; }
+
+private:
+    std::atomic<bool> m_stopRequested{false};
+    uint64_t m_startN = 11;
+    uint64_t m_limitP = 11;           // exclusivo, para o p inicial
+    unsigned m_threadCount = 0;
+    const LogBinLayout *m_binLayout = &LogBinLayout::standard();
+    ProgressCallback m_onProgress;
+    TupleAccumulator m_result;
+};
+
+// ======================= AMOSTRAGEM POR JANELAS =======================
+
+// Uma janela [start, end] varrida sem histórico no modo Twins: só as
+// transições entre twins da própria janela entram no kT, sem o transiente
+// de uma varredura cumulativa.
+struct SampleWindow {
+    uint128_t center = 0;
+    uint128_t start = 0, end = 0;
+    uint64_t twinCount = 0;
+    DecadeStats local;          // transições da janela; ⟨ln²p⟩ de [start, end]
+    double seconds = 0;
+    bool complete = false;      // false se a amostragem parou antes
+};
+
+// Janelas de largura fixa em centros log-espaçados, distribuídas entre as
+// threads (uma janela por vez em cada uma). Cada thread reaproveita seu
+// TwinSieve: com os centros em ordem crescente, os primos de crivo só são
+// gerados uma vez. Janelas que passam de 2⁶⁴ vão para o WideTwinSieve.
+class WindowSampler {
+public:
+    using WindowCallback = std::function<void(const SampleWindow &)>;
+
+    // Centros from·10^(k/perDecade) até to
+    static std::vector<uint128_t> logCenters(uint128_t from, uint128_t to, int perDecade)
+    {
+        std::vector<uint128_t> centers;
+        for (int k = 0;; ++k) {
+            const long double c = from * std::pow(10.0L, static_cast<long double>(k) / perDecade);
+            if (c > static_cast<long double>(to)) break;
+            centers.push_back(k == 0 ? from : static_cast<uint128_t>(std::round(c)));
+        }
+        return centers;
+    }
+
+    // Janelas de width números centradas em centers, cortadas em [3, 2¹²⁸ − 1]
+    void configure(const std::vector<uint128_t> &centers, uint64_t width)
+    {
+        m_windows.clear();
+        for (uint128_t c : centers) {
+            SampleWindow w;
+            w.center = c;
+            w.start = std::max<uint128_t>(3, c - std::min<uint128_t>(c, width / 2));
+            w.end = MAX_UINT128 - w.start < width - 1 ? MAX_UINT128 : w.start + width - 1;
+            m_windows.push_back(w);
+        }
+        m_stopRequested.store(false);
+    }
+
+    // Número de threads (0 = uma por núcleo)
+    void setThreadCount(unsigned n) { m_threadCount = n; }
+
+    // Cada janela concluída, em ordem, na thread que chama run()
+    void setWindowCallback(WindowCallback cb) { m_onWindow = std::move(cb); }
+
+    void run()
+    {
+        const size_t n = m_windows.size();
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::atomic<size_t> next{0};
+
+        auto work = [&] {
+            TwinSieve sieve;
+            WideTwinSieve wide;
+            for (size_t i; (i = next.fetch_add(1)) < n && !m_stopRequested.load();) {
+                const bool complete = m_windows[i].end > UINT64_MAX ? scanWideWindow(wide, m_windows[i])
+                                                                    : scanWindow(sieve, m_windows[i]);
+                std::lock_guard<std::mutex> lock(mutex);
+                m_windows[i].complete = complete;
+                cv.notify_all();
+            }
+        };
+        const unsigned nThreads = m_threadCount > 0 ? m_threadCount
+                                                    : std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < std::min<size_t>(nThreads, n); ++i)
+            threads.emplace_back(work);
+
+        for (size_t i = 0; i < n; ++i) {
+            {
+                // Espera com timeout: stop() só altera a flag atômica
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!m_windows[i].complete && !m_stopRequested.load())
+                    cv.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            if (!m_windows[i].complete) break;
+            if (m_onWindow) m_onWindow(m_windows[i]);
+        }
+        for (auto &t : threads) t.join();
+    }
+
+    // Pode ser chamado de qualquer thread; as janelas em curso são descartadas
+    void stop() { m_stopRequested.store(true); }
+
+    const std::vector<SampleWindow> &windows() const { return m_windows; }
+
+private:
+    // false se interrompida por stop()
+    bool scanWindow(TwinSieve &sieve, SampleWindow &w)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        ScanAccumulator acc;
+        sieve.reset(static_cast<uint64_t>(w.start), static_cast<uint64_t>(w.end) - 1);   // p + 2 ≤ end
+        while (sieve.nextSegment()) {
+            if (m_stopRequested.load()) return false;
+            sieve.forEachTuple([&](uint64_t p) { acc.addTwinPair(p); });
+        }
+        finishWindow(w, acc.twinCount, acc.sumTwinExcess, t0);
+        return true;
+    }
+
+    // Acima de 2⁶⁴ o ScanAccumulator (de 64 bits) não serve; a janela só
+    // precisa da contagem e do excesso de cada transição
+    bool scanWideWindow(WideTwinSieve &sieve, SampleWindow &w)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        uint64_t twins = 0;
+        ExactSum sumExcess = 0;
+        uint128_t lastP = 0;
+        int lastClass = -1;
+        sieve.reset(w.start, w.end - 1);
+        while (sieve.nextSegment()) {
+            if (m_stopRequested.load()) return false;
+            sieve.forEachTwin([&](uint128_t p) {
+                const int cls = classIndex(static_cast<uint64_t>(p % 30));
+                ++twins;
+                if (lastClass >= 0)
+                    sumExcess += static_cast<uint64_t>(p - lastP) - Constants::GAP_MIN[lastClass][cls];
+                lastP = p;
+                lastClass = cls;
+            });
+        }
+        finishWindow(w, twins, sumExcess, t0);
+        return true;
+    }
+
+    static void finishWindow(SampleWindow &w, uint64_t twins, ExactSum sumExcess,
+                             std::chrono::steady_clock::time_point t0)
+    {
+        w.twinCount = twins;
+        w.local.count = twins > 1 ? twins - 1 : 0;
+        w.local.sumExcess = sumExcess;
+        w.local.sumLn2 = static_cast<long double>(w.local.count)
+                         * LogBinLayout::twinMeanLn2(w.start, w.end == MAX_UINT128 ? w.end : w.end + 1);
+        w.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    std::vector<SampleWindow> m_windows;
+    unsigned m_threadCount = 0;
+    WindowCallback m_onWindow;
+    std::atomic<bool> m_stopRequested{false};
+};
+
+// ======================= ENUMERAÇÃO =======================
+
+// Acesso direto aos crivos para quem só quer os números, por callback (push)
+// ou por cursor (pull). Ao contrário de Scanner, incluem os primos 2, 3, 5, 7
+// e os twins (3, 5), (5, 7).
+
+// Primos de [lo, hi] em ordem crescente
+template <class F>
+inline void forEachPrime(uint64_t lo, uint64_t hi, F f)
+{
+    for (uint64_t p : {2, 3, 5, 7})
+        if (p >= lo && p <= hi) f(p);
+    if (hi < 11) return;
+    if (preferWheelTest(lo, hi)) {
+        WheelTestSieve test(lo, hi, false);
+        while (test.nextSegment())
+            test.forEach(f);
+        return;
+    }
+    PrimeSieve sieve(std::max<uint64_t>(lo, 11), hi == UINT64_MAX ? UINT64_MAX : hi + 1);
+    while (sieve.nextSegment())
+        sieve.forEachPrime(f);
+}
+
+// p dos twins (p, p+2) com lo ≤ p e p+2 ≤ hi, em ordem crescente
+template <class F>
+inline void forEachTwin(uint64_t lo, uint64_t hi, F f)
+{
+    for (uint64_t p : {3, 5})
+        if (p >= lo && p + 2 <= hi) f(p);
+    if (hi < 13) return;
+    if (preferWheelTest(lo, hi)) {
+        WheelTestSieve test(lo, hi, true);
+        while (test.nextSegment())
+            test.forEach(f);
+        return;
+    }
+    TwinSieve sieve(std::max<uint64_t>(lo, 11), hi - 1);
+    while (sieve.nextSegment())
+        sieve.forEachTuple(f);
+}
+
+// Cursor sobre os primos de [lo, hi]: next(p) devolve o próximo ou false no
+// fim. Guarda um segmento do crivo (ou um bloco do caminho por teste) por vez.
+class PrimeCursor {
+public:
+    PrimeCursor(uint64_t lo, uint64_t hi)
+        : m_useTest(hi >= 11 && preferWheelTest(lo, hi)),
+          m_sieve(std::max<uint64_t>(lo, 11), m_useTest || hi < 11 ? std::max<uint64_t>(lo, 11)
+                                                : hi == UINT64_MAX ? UINT64_MAX : hi + 1),
+          m_test(lo, m_useTest ? hi : 0, false)
+    {
+        for (uint64_t p : {2, 3, 5, 7})
+            if (p >= lo && p <= hi) m_buffer.push_back(p);
+        m_done = hi < 11;
+    }
+
+    bool next(uint64_t &p)
+    {
+        while (m_pos == m_buffer.size()) {
+            if (m_done || !(m_useTest ? m_test.nextSegment() : m_sieve.nextSegment())) {
+                m_done = true;
+                return false;
+            }
+            m_buffer.clear();
+            m_pos = 0;
+            auto push = [this](uint64_t q) { m_buffer.push_back(q); };
+            if (m_useTest)
+                m_test.forEach(push);
+            else
+                m_sieve.forEachPrime(push);
+        }
+        p = m_buffer[m_pos++];
+        return true;
+    }
+
+private:
+    bool m_useTest;
+    PrimeSieve m_sieve;
+    WheelTestSieve m_test;
+    std::vector<uint64_t> m_buffer;
+    size_t m_pos = 0;
+    bool m_done = false;
+};
+
+// Cursor sobre os twins (p, p+2) com lo ≤ p e p+2 ≤ hi; next(p) devolve o
+// menor primo do próximo par
+class TwinCursor {
+public:
+    TwinCursor(uint64_t lo, uint64_t hi)
+        : m_useTest(hi >= 13 && preferWheelTest(lo, hi)),
+          m_sieve(std::max<uint64_t>(lo, 11), hi < 13 || m_useTest ? 11 : hi - 1),
+          m_test(lo, m_useTest ? hi : 0, true)
+    {
+        for (uint64_t p : {3, 5})
+            if (p >= lo && p + 2 <= hi) m_buffer.push_back(p);
+        m_done = hi < 13;
+    }
+
+    bool next(uint64_t &p)
+    {
+        while (m_pos == m_buffer.size()) {
+            if (m_done || !(m_useTest ? m_test.nextSegment() : m_sieve.nextSegment())) {
+                m_done = true;
+                return false;
+            }
+            m_buffer.clear();
+            m_pos = 0;
+            auto push = [this](uint64_t q) { m_buffer.push_back(q); };
+            if (m_useTest)
+                m_test.forEach(push);
+            else
+                m_sieve.forEachTuple(push);
+        }
+        p = m_buffer[m_pos++];
+        return true;
+    }
+
+private:
+    bool m_useTest;
+    TwinSieve m_sieve;
+    WheelTestSieve m_test;
+    std::vector<uint64_t> m_buffer;
+    size_t m_pos = 0;
+    bool m_done = false;
+};
+
+// ======================= CONTAGEM DE PRIMOS π(x) =======================
+
+// π(x) sem enumerar os primos, pelo método combinatório de Lagarias-Miller-
+// Odlyzko: O(x^(2/3) / log x) operações. Com y = α·x^(1/3) e a = π(y),
+//     π(x) = φ(x, a) + a − 1 − P2(x, a),
+// onde φ(x, a) conta os n ≤ x sem fator primo ≤ p_a e P2(x, a) os n ≤ x com
+// exatamente dois fatores primos > y. φ(x, a) se divide nas folhas
+// ordinárias S1 (n ≤ y) e nas especiais S2, cujos φ(x/n, b) saem de um
+// crivo segmentado de [0, x/y) com um contador por bloco de 1024 bits.
+// S2 e P2 rodam em paralelo por blocos; as somas parciais são combinadas em
+// ordem no fim.
+class PrimeCounter {
+public:
+    // Abaixo disto o crivo comum é mais rápido
+    static constexpr uint64_t SIEVE_LIMIT = 10000000;
+
+    // Número de threads (0 = uma por núcleo)
+    void setThreadCount(unsigned n) { m_threadCount = n; }
+
+    // Interrompe count(), que devolve 0 desta chamada em diante; pode vir de
+    // qualquer thread
+    void stop() { m_stopRequested.store(true); }
+
+    uint64_t count(uint64_t x)
+    {
+        if (m_stopRequested.load()) return 0;
+        if (x < SIEVE_LIMIT) {
+            uint64_t n = 0;
+            forEachPrime(0, x, [&](uint64_t) { ++n; });
+            return n;
+        }
+
+        init(x);
+        const __int128 phi = ordinaryLeaves() + specialLeaves();
+        const __int128 p2 = twoFactorCount();
+        if (m_stopRequested.load()) return 0;
+        return static_cast<uint64_t>(phi + __int128(a()) - 1 - p2);
+    }
+
+private:
+    // φ(z, c) vem de uma tabela sobre 2·3·5·7·11·13 = 30030
+    static constexpr unsigned C = 6;
+    static constexpr uint32_t WHEEL = 30030;
+    static constexpr uint32_t WHEEL_TOTIENT = 5760;
+    static constexpr unsigned COUNTER_SHIFT = 10;
+
+    static uint64_t isqrt(uint64_t x)
+    {
+        uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(x)));
+        while (__uint128_t(r) * r > x) --r;
+        while (__uint128_t(r + 1) * (r + 1) <= x) ++r;
+        return r;
+    }
+
+    static uint64_t icbrt(uint64_t x)
+    {
+        uint64_t r = static_cast<uint64_t>(std::cbrt(static_cast<double>(x)));
+        while (__uint128_t(r) * r * r > x) --r;
+        while (__uint128_t(r + 1) * (r + 1) * (r + 1) <= x) ++r;
+        return r;
+    }
+
+    unsigned threadCount() const
+    {
+        return m_threadCount > 0 ? m_threadCount
+                                 : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // work() em threadCount() threads (a atual inclusive)
+    template <class F>
+    void runParallel(F work) const
+    {
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < threadCount(); ++i)
+            threads.emplace_back(work);
+        work();
+        for (auto &t : threads) t.join();
+    }
+
+    uint64_t a() const { return m_primes.size() - 1; }
+
+    // y, primos até y (m_primes[b] = p_b, base 1), μ·lpf e a tabela de φ(·, C)
+    void init(uint64_t x)
+    {
+        m_x = x;
+        // α cresce devagar com x: equilibra as folhas especiais (~y²) com o
+        // crivo de S2 (~x/y); medido entre 10¹² e 10¹⁵
+        const double alpha = std::max(1.0, std::log(static_cast<double>(x)) / 9);
+        m_y = static_cast<uint64_t>(alpha * static_cast<double>(icbrt(x)));
+        m_y = std::max(m_y, icbrt(x));
+        m_y = std::min(m_y, isqrt(x));
+
+        // μ(n)·lpf(n) em um int32: sinal = μ, módulo = menor fator primo,
+        // 0 se n não é livre de quadrados; lpf(1) = ∞
+        m_muLpf.assign(m_y + 1, 0);
+        std::vector<int8_t> mu(m_y + 1, 1);
+        m_primes.assign(1, 0);
+        for (uint64_t p = 2; p <= m_y; ++p) {
+            if (m_muLpf[p] != 0) continue;
+            m_primes.push_back(static_cast<uint32_t>(p));
+            for (uint64_t j = p; j <= m_y; j += p) {
+                if (m_muLpf[j] == 0) m_muLpf[j] = static_cast<int32_t>(p);
+                mu[j] = -mu[j];
+            }
+            for (uint64_t j = p * p; j <= m_y; j += p * p)
+                mu[j] = 0;
+        }
+        m_muLpf[1] = INT32_MAX;
+        for (uint64_t n = 2; n <= m_y; ++n)
+            m_muLpf[n] *= mu[n];
+
+        m_phiWheel.assign(WHEEL, 0);
+        for (uint32_t r = 1, n = 0; r < WHEEL; ++r) {
+            if (r % 2 && r % 3 && r % 5 && r % 7 && r % 11 && r % 13) ++n;
+            m_phiWheel[r] = static_cast<uint16_t>(n);
+        }
+    }
+
+    uint64_t phiWheel(uint64_t z) const
+    {
+        return z / WHEEL * WHEEL_TOTIENT + m_phiWheel[z % WHEEL];
+    }
+
+    // Número de primos ≤ n, para n ≤ y
+    uint64_t piSmall(uint64_t n) const
+    {
+        return std::upper_bound(m_primes.begin() + 1, m_primes.end(), n) - (m_primes.begin() + 1);
+    }
+
+    // S1 = Σ μ(n)·φ(x/n, C) sobre n ≤ y livres de quadrados com lpf(n) > p_C
+    __int128 ordinaryLeaves() const
+    {
+        __int128 s1 = 0;
+        for (uint64_t n = 1; n <= m_y; ++n) {
+            const int32_t v = m_muLpf[n];
+            if (v > 13) s1 += phiWheel(m_x / n);
+            else if (v < -13) s1 -= phiWheel(m_x / n);
+        }
+        return s1;
+    }
+
+    // Somas de um bloco de segmentos, relativas ao início do bloco: φ local
+    // por b e Σμ das folhas, para corrigir com o φ acumulado dos blocos
+    // anteriores na combinação
+    struct LeafBlock {
+        __int128 s2 = 0;
+        std::vector<int64_t> phi, muSum;
+    };
+
+    // Bits em [from, to] (from alinhado a 64)
+    static uint64_t countBits(const uint64_t *bits, uint64_t from, uint64_t to)
+    {
+        uint64_t n = 0;
+        const uint64_t last = to >> 6;
+        for (uint64_t w = from >> 6; w < last; ++w)
+            n += __builtin_popcountll(bits[w]);
+        return n + __builtin_popcountll(bits[last] & (~uint64_t(0) >> (63 - (to & 63))));
+    }
+
+    // Posição do primeiro múltiplo ímpar de p ≥ low (os pares já saíram)
+    static uint64_t firstOddMultiple(uint64_t p, uint64_t low)
+    {
+        uint64_t m = (low + p - 1) / p * p;
+        if (m % 2 == 0) m += p;
+        return m - low;
+    }
+
+    // Folhas especiais n = p_b·m com m ≤ y < n, lpf(m) > p_b, cujo
+    // z = x/n cai em [low, high); contribuem −μ(m)·φ(z, b−1). O crivo
+    // começa sem os múltiplos de p_1..p_C e perde os de p_b depois das
+    // folhas de b.
+    void sieveSegment(uint64_t low, uint64_t high, LeafBlock &block,
+                      std::vector<uint64_t> &bits, std::vector<uint32_t> &counters) const
+    {
+        const uint64_t size = high - low;
+        const uint64_t words = (size + 63) / 64;
+        // low é múltiplo de 64: os bits pares são os números pares
+        std::fill(bits.begin(), bits.begin() + words, 0xAAAAAAAAAAAAAAAAULL);
+        if (size % 64) bits[words - 1] &= ~uint64_t(0) >> (64 - size % 64);
+        for (unsigned b = 2; b <= C; ++b) {
+            const uint64_t p = m_primes[b];
+            for (uint64_t i = firstOddMultiple(p, low); i < size; i += 2 * p)
+                bits[i >> 6] &= ~(uint64_t(1) << (i & 63));
+        }
+        const uint64_t numCounters = ((size - 1) >> COUNTER_SHIFT) + 1;
+        int64_t unsieved = 0;
+        for (uint64_t k = 0; k < numCounters; ++k) {
+            const uint64_t from = k << COUNTER_SHIFT;
+            counters[k] = static_cast<uint32_t>(
+                countBits(bits.data(), from, std::min(size, from + (uint64_t(1) << COUNTER_SHIFT)) - 1));
+            unsieved += counters[k];
+        }
+
+        for (uint64_t b = C + 1; b < a(); ++b) {
+            const uint64_t p = m_primes[b];
+            const uint64_t xp = m_x / p;
+            const uint64_t maxM = low == 0 ? m_y : std::min(xp / low, m_y);
+            const uint64_t minM = std::max({xp / high, m_y / p, p});
+            // maxM só diminui com p: nenhum b seguinte tem folhas aqui
+            if (p >= maxM) break;
+            if (block.phi.size() <= b) {
+                block.phi.resize(b + 1, 0);
+                block.muSum.resize(b + 1, 0);
+            }
+            if (minM < maxM) {
+                // z cresce quando m diminui: os contadores são somados uma vez
+                uint64_t counter = 0;
+                int64_t counted = block.phi[b];
+                auto phi = [&](uint64_t z) {
+                    const uint64_t i = z - low, k = i >> COUNTER_SHIFT;
+                    while (counter < k) counted += counters[counter++];
+                    return counted + static_cast<int64_t>(countBits(bits.data(), k << COUNTER_SHIFT, i));
+                };
+                int64_t muSum = 0;
+                if (p * p <= m_y) {
+                    for (uint64_t m = maxM; m > minM; --m) {
+                        const int32_t v = m_muLpf[m];
+                        if (v > static_cast<int64_t>(p)) {
+                            block.s2 -= phi(xp / m);
+                            ++muSum;
+                        } else if (v < -static_cast<int64_t>(p)) {
+                            block.s2 += phi(xp / m);
+                            --muSum;
+                        }
+                    }
+                } else {
+                    // m ≤ y < p²: m é um primo em (minM, maxM]
+                    for (uint64_t k = piSmall(maxM), first = piSmall(minM); k > first; --k) {
+                        block.s2 += phi(xp / m_primes[k]);
+                        --muSum;
+                    }
+                }
+                block.muSum[b] += muSum;
+            }
+            block.phi[b] += unsieved;
+
+            for (uint64_t i = firstOddMultiple(p, low); i < size; i += 2 * p) {
+                const uint64_t mask = uint64_t(1) << (i & 63);
+                if (bits[i >> 6] & mask) {
+                    bits[i >> 6] &= ~mask;
+                    --counters[i >> COUNTER_SHIFT];
+                    --unsieved;
+                }
+            }
+        }
+    }
+
+    // S2 sobre [0, x/y]
+    __int128 specialLeaves()
+    {
+        const uint64_t limit = m_x / m_y + 1;
+        uint64_t segment = uint64_t(1) << 16;
+        while (segment * segment < limit && segment < (uint64_t(1) << 21)) segment <<= 1;
+        const uint64_t numSegments = (limit + segment - 1) / segment;
+        const uint64_t perBlock = std::max<uint64_t>(1, numSegments / (32 * threadCount()));
+        const uint64_t numBlocks = (numSegments + perBlock - 1) / perBlock;
+
+        std::vector<LeafBlock> blocks(numBlocks);
+        std::atomic<uint64_t> nextBlock{0};
+        runParallel([&] {
+            std::vector<uint64_t> bits(segment / 64);
+            std::vector<uint32_t> counters(segment >> COUNTER_SHIFT);
+            for (uint64_t idx; (idx = nextBlock.fetch_add(1)) < numBlocks && !m_stopRequested.load();) {
+                const uint64_t last = std::min(numSegments, (idx + 1) * perBlock);
+                for (uint64_t s = idx * perBlock; s < last && !m_stopRequested.load(); ++s)
+                    sieveSegment(s * segment, std::min(limit, (s + 1) * segment), blocks[idx], bits, counters);
+            }
+        });
+
+        std::vector<int64_t> phi(a() + 1, 0);
+        __int128 s2 = 0;
+        for (const LeafBlock &block : blocks) {
+            s2 += block.s2;
+            for (size_t b = 0; b < block.phi.size(); ++b) {
+                s2 -= __int128(block.muSum[b]) * phi[b];
+                phi[b] += block.phi[b];
+            }
+        }
+        return s2;
+    }
+
+    // P2(x, a) = Σ_{y < p ≤ √x} (π(x/p) − π(p) + 1). Os π(x/p) saem de um
+    // crivo de [√x, x/y) em blocos; cada bloco conta os primos até cada
+    // alvo x/p dentro dele, e o π do início do bloco entra na combinação.
+    __int128 twoFactorCount()
+    {
+        const uint64_t sq = isqrt(m_x);
+        if (sq <= m_y || m_stopRequested.load()) return 0;
+
+        uint64_t piSq = 0, lastPrime = 0;
+        forEachPrime(0, sq, [&](uint64_t p) { ++piSq; lastPrime = p; });
+
+        struct Chunk { __int128 sum = 0; uint64_t targets = 0, primes = 0; };
+        const uint64_t low = sq, high = m_x / (m_y + 1) + 1;
+        const uint64_t chunkSize = std::max<uint64_t>(uint64_t(1) << 24, (high - low) / (16 * threadCount()) + 1);
+        const uint64_t numChunks = (high - low + chunkSize - 1) / chunkSize;
+
+        std::vector<Chunk> chunks(numChunks);
+        std::atomic<uint64_t> nextChunk{0};
+        runParallel([&] {
+            PrimeSieve sieve;
+            std::vector<uint64_t> targets;
+            for (uint64_t idx; (idx = nextChunk.fetch_add(1)) < numChunks && !m_stopRequested.load();) {
+                const uint64_t lo = low + idx * chunkSize;
+                const uint64_t hi = std::min(high, lo + chunkSize);
+                // x/p ∈ [lo, hi) ⟺ p ∈ (x/hi, x/lo]
+                const uint64_t pLo = std::max(m_y, m_x / hi) + 1;
+                const uint64_t pHi = std::min(sq, m_x / lo);
+                targets.clear();
+                if (pLo <= pHi) {
+                    sieve.reset(pLo, pHi + 1);
+                    while (sieve.nextSegment())
+                        sieve.forEachPrime([&](uint64_t p) { targets.push_back(m_x / p); });
+                }
+                std::reverse(targets.begin(), targets.end());
+
+                Chunk &c = chunks[idx];
+                size_t t = 0;
+                sieve.reset(lo, hi);
+                while (sieve.nextSegment()) {
+                    sieve.forEachPrime([&](uint64_t q) {
+                        for (; t < targets.size() && targets[t] < q; ++t) c.sum += c.primes;
+                        ++c.primes;
+                    });
+                }
+                for (; t < targets.size(); ++t) c.sum += c.primes;
+                c.targets = targets.size();
+            }
+        });
+
+        __int128 sum = 0;
+        uint64_t prefix = piSq - (lastPrime == sq ? 1 : 0);
+        for (const Chunk &c : chunks) {
+            sum += c.sum + __int128(c.targets) * prefix;
+            prefix += c.primes;
+        }
+        // Σ_{a < k ≤ π(√x)} (k − 1)
+        const __int128 b = piSq;
+        return sum - (b * (b - 1) - __int128(a()) * (a() - 1)) / 2;
+    }
+
+    uint64_t m_x = 0, m_y = 0;
+    std::vector<uint32_t> m_primes;
+    std::vector<int32_t> m_muLpf;
+    std::vector<uint16_t> m_phiWheel;
+    unsigned m_threadCount = 0;
+    std::atomic<bool> m_stopRequested{false};
+};
+
+// π(x) pelo PrimeCounter
+inline uint64_t primePi(uint64_t x, unsigned threads = 0)
+{
+    PrimeCounter counter;
+    counter.setThreadCount(threads);
+    return counter.count(x);
+}
+
+// Logaritmo integral deslocado Li(x) = li(x) − li(2), pela série de Ramanujan
+inline long double offsetLogIntegral(long double x)
+{
+    constexpr long double EULER_GAMMA = 0.5772156649015328606065120900824024L;
+    constexpr long double LI2 = 1.0451637801174927848445888891946131L;
+    const long double lx = std::log(x);
+    long double sum = 0, term = 1, inner = 0;
+    for (int n = 1; n < 200; ++n) {
+        term *= lx / n;                           // (ln x)^n / n!
+        if ((n - 1) % 2 == 0) inner += 1.0L / n;  // Σ_{k ≤ (n−1)/2} 1/(2k+1)
+        const long double t = term / std::ldexp(1.0L, n - 1) * inner;
+        sum += n % 2 ? t : -t;
+        if (std::fabs(t) < 1e-22L * std::fabs(sum)) break;
+    }
+    return EULER_GAMMA + std::log(lx) + std::sqrt(x) * sum - LI2;
+}
+
+// ======================= VERIFICAÇÃO XOR =======================
+
+// Teorema das três famílias (MANUAL §7). Para P primo ímpar, T = v₂(P+1) se
+// P+2 é primo e v₂(P−1) caso contrário; K = P ⊕ (P+2) no primeiro caso e
+// (P−1) ⊕ (P+1) no segundo:
+//   C_twin: P+2 primo          K = 2^(T+1) − 2
+//   C_≥2:   não twin, T ≥ 2    K = 2
+//   C_T=1:  não twin, T = 1    K = 2^m − 2, m ≥ 3
+// As assinaturas K valem para qualquer P ímpar (cadeia de carry em binário) e
+// não são conferidas: o que pode falhar é a classificação, se P+2 é primo.
+// XorTally conta os primos por família e por T e separa os C_twin de que o
+// TwinSieve discorda nos dois sentidos.
+struct XorTally {
+    enum Family { TWIN, HIGH, T_ONE, FAMILIES };   // C_twin, C_≥2, C_T=1
+    static constexpr int MAX_T = 64;
+    static constexpr size_t MAX_COUNTEREXAMPLES = 64;
+
+    uint64_t byT[FAMILIES][MAX_T] = {};    // primos da família com aquele T
+    uint64_t primes = 0;
+    uint64_t twinMismatches = 0;
+    // Os primeiros P de cada lado da discordância, em ordem crescente ao fim:
+    // C_twin pelo gap do PrimeSieve sem o par no TwinSieve, e o contrário
+    std::vector<uint64_t> primeSieveOnly;
+    std::vector<uint64_t> twinSieveOnly;
+
+    // Último primo do trecho corrente; o twin dele depende do primo seguinte
+    uint64_t lastPrime = 0;
+
+    static const char *familyName(int family)
+    {
+        static const char *const names[FAMILIES] = {"C_twin", "C_>=2", "C_T=1"};
+        return names[family];
+    }
+
+    uint64_t familyCount(int family) const
+    {
+        uint64_t total = 0;
+        for (uint64_t c : byT[family]) total += c;
+        return total;
+    }
+
+    void merge(const XorTally &other)
+    {
+        for (int f = 0; f < FAMILIES; ++f)
+            for (int t = 0; t < MAX_T; ++t)
+                byT[f][t] += other.byT[f][t];
+        primes += other.primes;
+        twinMismatches += other.twinMismatches;
+        mergeCounterexamples(primeSieveOnly, other.primeSieveOnly);
+        mergeCounterexamples(twinSieveOnly, other.twinSieveOnly);
+    }
+
+    void addMismatch(uint64_t p, bool fromPrimeSieve)
+    {
+        ++twinMismatches;
+        auto &list = fromPrimeSieve ? primeSieveOnly : twinSieveOnly;
+        if (list.size() < MAX_COUNTEREXAMPLES) list.push_back(p);
+    }
+
+    // Primo seguinte do trecho, um a um (WheelTestSieve e primos pequenos)
+    void addPrime(uint64_t p, std::vector<uint64_t> &twins)
+    {
+        if (lastPrime != 0 && p - lastPrime == 2) promote(lastPrime, twins);
+        countNonTwin(p);
+        lastPrime = p;
+        ++primes;
+    }
+
+    // Segmento atual do PrimeSieve inteiro, lido do bitmap como em
+    // ScanAccumulator::addSegment: cada primo entra como não twin, com a
+    // família e o T de v₂(P−1) (um ctz), e os bits de PrimeSieve::twinWord
+    // o passam para C_twin. Anexa a twins os P de C_twin, em ordem.
+    void addSegment(const PrimeSieve &sieve, std::vector<uint64_t> &twins)
+    {
+        const uint64_t *words = sieve.words();
+        const uint64_t numWords = sieve.wordCount();
+        uint64_t w0 = 0;
+        while (w0 < numWords && words[w0] == 0) ++w0;
+        if (w0 == numWords) return;
+
+        // Costura com o segmento anterior: o twin que atravessa a fronteira
+        const uint64_t first = sieve.valueAt(w0 * 64 + __builtin_ctzll(words[w0]));
+        if (lastPrime != 0 && first - lastPrime == 2) promote(lastPrime, twins);
+
+        uint64_t count = 0, last = 0;
+        for (uint64_t w = w0; w < numWords; ++w) {
+            uint64_t bits = words[w];
+            count += __builtin_popcountll(bits);
+            while (bits) {
+                last = sieve.valueAt(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+                countNonTwin(last);
+            }
+        }
+        for (uint64_t w = w0; w < numWords; ++w) {
+            uint64_t bits = sieve.twinWord(w);
+            while (bits) {
+                const uint64_t p = sieve.valueAt(w * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
+                promote(p, twins);
+            }
+        }
+        primes += count;
+        lastPrime = last;
+    }
+
+    // Fim do trecho: o primo seguinte ao último está fora dele, e só importa
+    // saber se é P+2, o que Miller-Rabin decide
+    void finishChunk(std::vector<uint64_t> &twins)
+    {
+        if (lastPrime != 0 && lastPrime <= UINT64_MAX - 2 && MillerRabin::isPrime(lastPrime + 2))
+            promote(lastPrime, twins);
+        lastPrime = 0;
+    }
+
+private:
+    // Não twin: C_≥2 ou C_T=1 conforme T = v₂(P−1), sem desvio
+    void countNonTwin(uint64_t p)
+    {
+        const unsigned down = __builtin_ctzll(p - 1);
+        ++byT[HIGH + (down == 1)][down];
+    }
+
+    // P+2 é primo: sai da família de v₂(P−1) e entra em C_twin com v₂(P+1)
+    void promote(uint64_t p, std::vector<uint64_t> &twins)
+    {
+        const unsigned down = __builtin_ctzll(p - 1);
+        --byT[HIGH + (down == 1)][down];
+        ++byT[TWIN][__builtin_ctzll(p + 1)];
+        twins.push_back(p);
+    }
+
+    static void mergeCounterexamples(std::vector<uint64_t> &list, const std::vector<uint64_t> &other)
+    {
+        list.insert(list.end(), other.begin(), other.end());
+        std::sort(list.begin(), list.end());
+        if (list.size() > MAX_COUNTEREXAMPLES) list.resize(MAX_COUNTEREXAMPLES);
+    }
+};
+
+// Verificação em massa de [start, end]: trechos independentes distribuídos
+// entre as threads, cada um crivado pelo PrimeSieve. Cada segmento vai
+// inteiro para XorTally::addSegment, direto do bitmap; o último primo fica
+// pendente até o primeiro do segmento seguinte, e o do fim do trecho decide o
+// twin por Miller-Rabin. Os twins assim classificados são conferidos contra o
+// TwinSieve no mesmo trecho, que risca os pares direto, sem olhar gaps entre
+// primos.
+class XorVerifier {
+public:
+    // Números cobertos até agora (soma dos trechos concluídos)
+    using ProgressCallback = std::function<void(uint64_t)>;
+
+    void configure(uint64_t start, uint64_t end)
+    {
+        m_start = std::max<uint64_t>(start, 3);
+        m_end = end;
+        m_result = XorTally();
+        m_stopRequested.store(false);
+    }
+
+    // Número de threads (0 = uma por núcleo)
+    void setThreadCount(unsigned n) { m_threadCount = n; }
+
+    // Chamado por uma das threads de trabalho, sob mutex
+    void setProgressCallback(ProgressCallback cb) { m_onProgress = std::move(cb); }
+
+    // false se interrompida por stop()
+    bool run()
+    {
+        XorTally total;
+        if (m_end < m_start) {
+            m_result = total;
+            return true;
+        }
+
+        // 3, 5 e 7 ficam fora da wheel; (3, 5) e (5, 7) estão abaixo do TwinSieve
+        std::vector<uint64_t> smallTwins;
+        for (uint64_t p : {3, 5, 7})
+            if (p >= m_start && p <= m_end) total.addPrime(p, smallTwins);
+        total.finishChunk(smallTwins);
+
+        const uint64_t lo = std::max<uint64_t>(m_start, 11);
+        const uint64_t hi = m_end == UINT64_MAX ? UINT64_MAX : m_end + 1;   // exclusivo; 2⁶⁴−1 não é primo
+        const unsigned nThreads = m_threadCount > 0 ? m_threadCount
+                                                    : std::max(1u, std::thread::hardware_concurrency());
+        bool complete = true;
+        if (lo < hi) {
+            const uint64_t span = hi - lo;
+            const uint64_t chunk = std::clamp<uint64_t>(span / (16 * nThreads) + 1, MIN_CHUNK, MAX_CHUNK);
+            const uint64_t numChunks = span / chunk + (span % chunk != 0);
+
+            std::mutex mutex;
+            std::atomic<uint64_t> nextChunk{0};
+            uint64_t covered = 0;
+            auto work = [&] {
+                XorTally tally;
+                PrimeSieve sieve;
+                TwinSieve pairs;
+                std::vector<uint64_t> twins;
+                for (uint64_t idx; (idx = nextChunk.fetch_add(1)) < numChunks && !m_stopRequested.load();) {
+                    const uint64_t a = lo + idx * chunk;
+                    const uint64_t b = hi - a <= chunk ? hi : a + chunk;
+                    if (!verifyChunk(sieve, pairs, twins, a, b, tally)) break;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    covered += b - a;
+                    if (m_onProgress) m_onProgress(covered);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                total.merge(tally);
+            };
+            std::vector<std::thread> threads;
+            for (unsigned i = 1; i < std::min<uint64_t>(nThreads, numChunks); ++i)
+                threads.emplace_back(work);
+            work();
+            for (auto &t : threads) t.join();
+            complete = !m_stopRequested.load();
+        }
+        m_result = total;
+        return complete;
+    }
+
+    // Pode ser chamado de qualquer thread
+    void stop() { m_stopRequested.store(true); }
+
+    const XorTally &result() const { return m_result; }
+
+private:
+    static constexpr uint64_t MIN_CHUNK = uint64_t(1) << 24;
+    static constexpr uint64_t MAX_CHUNK = uint64_t(1) << 32;
+
+    // Primos de [a, b); false se interrompido. Trechos estreitos em magnitude
+    // alta vão pelo WheelTestSieve, como em forEachPrime
+    bool verifyChunk(PrimeSieve &sieve, TwinSieve &pairs, std::vector<uint64_t> &twins,
+                     uint64_t a, uint64_t b, XorTally &tally)
+    {
+        twins.clear();
+        if (preferWheelTest(a, b - 1)) {
+            WheelTestSieve test(a, b - 1, false);
+            while (test.nextSegment()) {
+                if (m_stopRequested.load()) return false;
+                test.forEach([&](uint64_t p) { tally.addPrime(p, twins); });
+            }
+        } else {
+            sieve.reset(a, b);
+            while (sieve.nextSegment()) {
+                if (m_stopRequested.load()) return false;
+                tally.addSegment(sieve, twins);
+            }
+        }
+        tally.finishChunk(twins);
+
+        // Os dois crivos devem dar exatamente os mesmos P; cada P que só um
+        // deles dá é um contraexemplo da classificação
+        size_t i = 0;
+        pairs.reset(a, b);
+        while (pairs.nextSegment()) {
+            if (m_stopRequested.load()) return false;
+            pairs.forEachTuple([&](uint64_t p) {
+                for (; i < twins.size() && twins[i] < p; ++i) tally.addMismatch(twins[i], true);
+                if (i < twins.size() && twins[i] == p) ++i;
+                else tally.addMismatch(p, false);
+            });
+        }
+        for (; i < twins.size(); ++i) tally.addMismatch(twins[i], true);
+        return true;
+    }
+
+    uint64_t m_start = 3;
+    uint64_t m_end = 0;
+    unsigned m_threadCount = 0;
+    ProgressCallback m_onProgress;
+    XorTally m_result;
+    std::atomic<bool> m_stopRequested{false};
+};
+
+} // namespace thermo
+
+#endif // THERMO_ENGINE_H
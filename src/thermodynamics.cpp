@@ -1,98 +1,26 @@
 #include <QtWidgets>
-#include <atomic>
+#include <algorithm>
 #include <cmath>
-#include <vector>
-#include <array>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thermo_engine.h"
 
 // ═══════════════════════════════════════════════════════════════════════════
 //                    TERMODINÂMICA DOS PRIMOS v4.2
 //           Implementação baseada no framework de máxima entropia
-//           Com Miller-Rabin para teste de primalidade
-//           Wheel mod 210 como filtro inicial
+//           Crivo segmentado no layout da wheel mod 210
+//           Miller-Rabin para testes isolados de primalidade
+//           Interface Qt sobre o motor de thermo_engine.h
 // ═══════════════════════════════════════════════════════════════════════════
 
-// ======================= CONSTANTES FUNDAMENTAIS =======================
-
-namespace Constants {
-    // Hardy-Littlewood C₂ para twins (alta precisão)
-    constexpr long double C2 = 0.6601618158468695739278121100145557L;
-
-    // === MODELO CUMULATIVO ===
-    // kT_cum = a×ln²(p) + b×ln(p) + c
-    constexpr double kT_CUM_LN2 = 0.7784;
-    constexpr double kT_CUM_LN = -2.32;
-    constexpr double kT_CUM_C = -13.9;
-
-    // === MODELO LOCAL (por década) ===
-    // kT_local ≈ 0.75×ln²(p) - 17 (Hardy-Littlewood puro!)
-    constexpr double kT_LOC_LN2 = 0.7499;   // ≈ 1/(2C₂)
-    constexpr double kT_LOC_LN = -0.24;     // ≈ 0
-    constexpr double kT_LOC_C = -16.7;      // ≈ gap_min médio
-
-    // Offset para primos: gap_min = 2
-    constexpr double OFFSET_PRIMES = 2.0;
-
-    // Valor teórico do ratio kT/ln²(p) (assintótico local)
-    constexpr double RATIO_THEORETICAL = 0.7499;
-
-    // kT binário = 1/ln(2) ≈ 1.4427 (FIXO)
-    constexpr long double kT_BINARY = 1.4426950408889634073599246810018921L;
-    constexpr long double LN2 = 0.6931471805599453094172321214581766L;
-
-    // Limiares de regime (descoberta empírica)
-    constexpr uint64_t FROZEN_LIMIT = 500;          // ~17º twin, gaps = gap_min
-    constexpr uint64_t TRANSITION_LIMIT = 10000;    // transição inicial
-    constexpr uint64_t ASYMPTOTIC_LIMIT = 100000;   // regime assintótico bom
-    constexpr uint64_t PRECISE_LIMIT = 1000000;     // regime preciso (>99%)
-
-    // Classes válidas para twin primes mod 30
-    constexpr int TWIN_CLASSES[3] = {11, 17, 29};
-
-    // Matriz de gap_min entre classes mod 30
-    constexpr int GAP_MIN[3][3] = {
-        {30,  6, 18},  // de 11 → {11, 17, 29}
-        {24, 30, 12},  // de 17 → {11, 17, 29}
-        {12, 18, 30}   // de 29 → {11, 17, 29}
-    };
-
-    // Wheel mod 210 = 2×3×5×7: 48 coprimos (muito mais eficiente)
-    constexpr int WHEEL_SIZE = 48;
-    constexpr int WHEEL_OFFSETS[48] = {
-        1, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47,
-        53, 59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103,
-        107, 109, 113, 121, 127, 131, 137, 139, 143, 149, 151, 157,
-        163, 167, 169, 173, 179, 181, 187, 191, 193, 197, 199, 209
-    };
-
-    // v₂ teórico (distribuição geométrica)
-    constexpr double V2_MEAN_THEORETICAL = 2.0;
-    constexpr double V2_P1_THEORETICAL = 0.5;
-    constexpr double V2_P2_THEORETICAL = 0.25;
-    constexpr double V2_P3_THEORETICAL = 0.125;
-}
-
-// ======================= MODELOS =======================
-
-enum class AnalysisMode { Primes, Twins, Both };
-
-// Regime do sistema
-enum class Regime {
-    Frozen,      // p < 500, gaps = gap_min
-    Transition,  // 500 < p < 10k
-    Asymptotic,  // 10k < p < 1M
-    Precise      // p > 1M, lei vale com R² > 0.99
-};
+using namespace thermo;
 
-inline const char* regimeName(Regime r) {
-    switch (r) {
-        case Regime::Frozen: return "CONGELADO";
-        case Regime::Transition: return "TRANSIÇÃO";
-        case Regime::Asymptotic: return "ASSINTÓTICO";
-        case Regime::Precise: return "PRECISO ✓";
-    }
-    return "?";
-}
+// ======================= MODELOS (Qt) =======================
 
 inline QString regimeColor(Regime r) {
     switch (r) {
@@ -104,551 +32,365 @@ inline QString regimeColor(Regime r) {
     return "black";
 }
 
-// Índice de classe mod 30 para twins
-inline int classIndex(uint64_t p) {
-    int r = p % 30;
-    if (r == 11) return 0;
-    if (r == 17) return 1;
-    if (r == 29) return 2;
-    return -1;
-}
+// ======================= WORKER =======================
 
-struct TransitionStats {
-    uint64_t count[3][3] = {{0}};
-    long double sumGap[3][3] = {{0}};
+// Adaptador Qt do Scanner: roda numa QThread e publica as Stats num
+// SnapshotBuffer que a janela lê no seu próprio ritmo (sem fila de eventos)
+class Worker : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr uint64_t PARALLEL_CHUNK = Scanner::PARALLEL_CHUNK;
 
-    double avgGap(int c1, int c2) const {
-        return count[c1][c2] > 0 ?
-            static_cast<double>(sumGap[c1][c2] / count[c1][c2]) : 0.0;
+    explicit Worker(QObject *parent = nullptr)
+        : QObject(parent), m_snapshots(std::make_shared<SnapshotBuffer<Stats>>())
+    {
+        m_scanner.setProgressCallback([this](const Stats &s) { m_snapshots->publish(s); });
+        m_scanner.setCheckpointErrorCallback([this](const std::string &error) {
+            emit checkpointFailed(QString::fromStdString(error));
+        });
+        m_scanner.setExportErrorCallback([this](const std::string &error) {
+            emit exportFailed(QString::fromStdString(error));
+        });
     }
 
-    double probability(int c1, int c2) const {
-        uint64_t total = 0;
-        for (int j = 0; j < 3; ++j) total += count[c1][j];
-        return total > 0 ? static_cast<double>(count[c1][c2]) / total : 0.0;
+    void configure(uint64_t startN, AnalysisMode mode, bool multiThread,
+                   uint64_t endN = UINT64_MAX)
+    {
+        m_scanner.configure(startN, mode, multiThread, endN);
     }
-};
 
-// Stats por década (10³, 10⁴, ..., 10¹⁰)
-struct DecadeStats {
-    uint64_t count = 0;
-    long double sumExcess = 0;
-    long double sumLn2 = 0;
+    void resume(const ScanCheckpoint &ckpt, bool multiThread) { m_scanner.resume(ckpt, multiThread); }
+    void setBinsPerDecade(int binsPerDecade) { m_scanner.setBinsPerDecade(binsPerDecade); }
+    void setThreadCount(unsigned n) { m_scanner.setThreadCount(n); }
 
-    double kT() const {
-        return count > 0 ? static_cast<double>(sumExcess / count) : 0;
-    }
+    // Último estado publicado; compartilhado para sobreviver ao Worker
+    std::shared_ptr<SnapshotBuffer<Stats>> snapshots() const { return m_snapshots; }
 
-    double avgLn2() const {
-        return count > 0 ? static_cast<double>(sumLn2 / count) : 0;
+    void setCheckpointFile(const QString &path, int intervalSec = 60)
+    {
+        m_scanner.setCheckpointFile(path.toStdString(), intervalSec);
     }
 
-    double ratio() const {
-        double ln2 = avgLn2();
-        return (count > 0 && ln2 > 0) ? kT() / ln2 : 0;
-    }
+    // Etapa opcional de saída: um registro por twin (vazio desliga)
+    void setTwinExportFile(const QString &path) { m_scanner.setTwinExportFile(path.toStdString()); }
 
-    double pctTheoretical() const {
-        return ratio() / Constants::RATIO_THEORETICAL * 100.0;
+public slots:
+    void process()
+    {
+        m_scanner.run();
+        emit finished();
     }
-};
-
-struct Stats {
-    uint64_t currentN = 0;
-    uint64_t primeCount = 0;
-    uint64_t twinCount = 0;
-
-    Regime regime = Regime::Frozen;
-
-    // Gaps médios
-    double avgPrimeGap = 0.0;
-    double avgTwinGap = 0.0;
-
-    // kT Primos: kT = ⟨gap⟩ - 2
-    double kTPrimeEmpirical = 0.0;
-    double kTPrimeTheoretical = 0.0;
-
-    // kT Twins
-    double kTTwinEmpirical = 0.0;
-    double kTTwinTheoretical = 0.0;
-    double kTTwinAsymptotic = 0.0;
-    uint64_t asymptoticCount = 0;
-
-    // Razão kT/ln²(p)
-    double kTRatio = 0.0;
-
-    // kT Binário
-    double kTBinary = Constants::kT_BINARY;
-
-    // v₂(p+1)
-    double meanV2 = 0.0;
-    uint64_t v2Histogram[8] = {0};
-
-    // v₂(gap) - trailing zeros do gap entre twins
-    double meanV2Gap = 0.0;
-    uint64_t v2GapHistogram[8] = {0};
-
-    // Correlação v₂(p+1) vs v₂(gap)
-    double corrV2 = 0.0;
 
-    // Transições mod 30
-    TransitionStats transitions;
+    void stop() { m_scanner.stop(); }
 
-    // R² de Boltzmann (consistência entre transições)
-    double boltzmannR2 = 0.0;
+signals:
+    void checkpointFailed(const QString &error);
+    void exportFailed(const QString &error);
+    void finished();
 
-    // Stats por década (índice 0 = 10³, 1 = 10⁴, ..., 7 = 10¹⁰)
-    static constexpr int N_DECADES = 8;
-    DecadeStats decades[N_DECADES];
+private:
+    Scanner m_scanner;
+    std::shared_ptr<SnapshotBuffer<Stats>> m_snapshots;
 };
 
-Q_DECLARE_METATYPE(Stats)
-
-// ======================= MILLER-RABIN COM WHEEL MOD 210 =======================
-
-// Multiplicação modular segura para evitar overflow
-static inline uint64_t mulmod(uint64_t a, uint64_t b, uint64_t m) {
-    return static_cast<__uint128_t>(a) * b % m;
-}
-
-// Exponenciação modular: base^exp mod m
-static inline uint64_t powmod(uint64_t base, uint64_t exp, uint64_t m) {
-    uint64_t result = 1;
-    base %= m;
-    while (exp > 0) {
-        if (exp & 1)
-            result = mulmod(result, base, m);
-        exp >>= 1;
-        base = mulmod(base, base, m);
-    }
-    return result;
-}
+// ======================= GRÁFICOS =======================
 
-// Miller-Rabin: teste de primalidade determinístico para n < 2^64
-// Usa testemunhas que garantem corretude para todo n < 2^64
-class MillerRabin {
+// Série de pontos com x crescente em memória fixa: até CAPACITY baldes, cada
+// um com o envelope min/max e o último y de pointsPerBucket() pontos seguidos.
+// Quando enche, os baldes são fundidos dois a dois e passam a cobrir o dobro
+// de pontos. append() custa O(1) amortizado, e uma varredura de dias ocupa a
+// mesma memória que uma de segundos.
+class DecimatedSeries
+{
 public:
-    // Teste determinístico usando testemunhas específicas
-    // Para n < 2^64, as testemunhas {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}
-    // são suficientes para determinar primalidade com certeza
-    static bool isPrime(uint64_t n) {
-        if (n < 2) return false;
-        if (n == 2 || n == 3) return true;
-        if (n % 2 == 0) return false;
-
-        // Para números pequenos, usar lista de primos conhecidos
-        if (n < 9) return n == 5 || n == 7;
-
-        // Escreve n-1 = 2^r * d onde d é ímpar
-        uint64_t d = n - 1;
-        int r = 0;
-        while ((d & 1) == 0) {
-            d >>= 1;
-            ++r;
-        }
-
-        // Testemunhas determinísticas para n < 2^64
-        // Fonte: https://miller-rabin.appspot.com/
-        static const uint64_t witnesses[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
-
-        for (uint64_t a : witnesses) {
-            if (a >= n) continue;
-            if (!millerRabinTest(n, d, r, a))
-                return false;
-        }
-        return true;
-    }
+    static constexpr int CAPACITY = 2048;   // par: halve() não deixa sobra
 
-    // Teste otimizado: assume que n já passou pelo filtro wheel mod 210
-    // (coprimo com 2, 3, 5, 7)
-    static bool isPrimeFromWheel(uint64_t n) {
-        // n já é coprimo com 2,3,5,7 pelo wheel
-        if (n < 121) return n > 1;  // 121 = 11², menor composto coprimo com 210
+    struct Bucket {
+        double xFirst, xLast;
+        double yMin, yMax, yLast;
+        uint64_t count;
+    };
 
-        // Escreve n-1 = 2^r * d onde d é ímpar
-        uint64_t d = n - 1;
-        int r = 0;
-        while ((d & 1) == 0) {
-            d >>= 1;
-            ++r;
-        }
+    DecimatedSeries() { m_buckets.reserve(CAPACITY); }
 
-        // Para n < 3,317,044,064,679,887,385,961,981 basta testar:
-        // {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}
-        // Como já filtramos por 2,3,5,7, podemos pular esses
-        static const uint64_t witnesses[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    void clear()
+    {
+        m_buckets.clear();
+        m_perBucket = 1;
+    }
 
-        for (uint64_t a : witnesses) {
-            if (a >= n) continue;
-            if (!millerRabinTest(n, d, r, a))
-                return false;
+    void append(double x, double y)
+    {
+        if (!std::isfinite(x) || !std::isfinite(y)) return;
+        if (!m_buckets.empty() && m_buckets.back().count < m_perBucket) {
+            Bucket &b = m_buckets.back();
+            b.xLast = x;
+            b.yMin = std::min(b.yMin, y);
+            b.yMax = std::max(b.yMax, y);
+            b.yLast = y;
+            ++b.count;
+            return;
         }
-        return true;
+        if (static_cast<int>(m_buckets.size()) == CAPACITY) halve();
+        m_buckets.push_back({x, x, y, y, y, 1});
     }
 
-private:
-    // Um round do teste Miller-Rabin
-    static bool millerRabinTest(uint64_t n, uint64_t d, int r, uint64_t a) {
-        uint64_t x = powmod(a, d, n);
+    bool empty() const { return m_buckets.empty(); }
+    const std::vector<Bucket> &buckets() const { return m_buckets; }
+    uint64_t pointsPerBucket() const { return m_perBucket; }
 
-        if (x == 1 || x == n - 1)
-            return true;
-
-        for (int i = 0; i < r - 1; ++i) {
-            x = mulmod(x, x, n);
-            if (x == n - 1)
-                return true;
+private:
+    void halve()
+    {
+        size_t out = 0;
+        for (size_t i = 0; i + 1 < m_buckets.size(); i += 2) {
+            const Bucket &a = m_buckets[i], &b = m_buckets[i + 1];
+            m_buckets[out++] = {a.xFirst, b.xLast, std::min(a.yMin, b.yMin),
+                                std::max(a.yMax, b.yMax), b.yLast, a.count + b.count};
         }
-        return false;
+        m_buckets.resize(out);
+        m_perBucket *= 2;
     }
+
+    std::vector<Bucket> m_buckets;
+    uint64_t m_perBucket = 1;
 };
 
-// Alias para manter compatibilidade
-class PrimeSieve {
+// Gráfico x-y desenhado por coluna de pixel. Os baldes de cada série que caem
+// numa coluna viram um traço vertical min..max e um ponto da linha (o último
+// y). Um repaint custa O(CAPACITY + largura), qualquer que seja o tamanho da
+// varredura. A referência teórica é calculada uma vez por coluna.
+class SeriesChart : public QWidget
+{
 public:
-    explicit PrimeSieve(uint64_t /*limit*/ = 10000000) {
-        // Miller-Rabin não precisa de pré-computação
+    SeriesChart(const QString &xLabel, const QString &yLabel, QWidget *parent = nullptr)
+        : QWidget(parent), m_xLabel(xLabel), m_yLabel(yLabel)
+    {
+        setMinimumHeight(180);
     }
 
-    bool isPrimeFromWheel(uint64_t n) const {
-        return MillerRabin::isPrimeFromWheel(n);
+    // Curva nova; dots = só os envelopes (pontos soltos, sem linha)
+    int addCurve(const QString &name, const QColor &color, bool dots = false)
+    {
+        m_curves.push_back({name, color, dots, DecimatedSeries()});
+        return static_cast<int>(m_curves.size()) - 1;
     }
 
-    bool isPrime(uint64_t n) const {
-        return MillerRabin::isPrime(n);
+    DecimatedSeries &series(int curve) { return m_curves[curve].series; }
+
+    void setReference(const QString &name, std::function<double(double)> f)
+    {
+        m_referenceName = name;
+        m_reference = std::move(f);
     }
-};
 
-// v₂(n) = trailing zeros
-static inline unsigned v2_of(uint64_t x) {
-    if (x == 0) return 0;
-    return __builtin_ctzll(x);
-}
+    void clear()
+    {
+        for (Curve &c : m_curves) c.series.clear();
+        update();
+    }
 
-// Wheel iterator mod 210 (filtro rápido antes do Miller-Rabin)
-class WheelIterator {
-public:
-    WheelIterator(uint64_t start) {
-        m_base = (start / 210) * 210;
-        m_idx = 0;
-        // Encontra primeiro offset >= start
-        for (int i = 0; i < Constants::WHEEL_SIZE; ++i) {
-            if (m_base + Constants::WHEEL_OFFSETS[i] >= start) {
-                m_idx = i;
-                return;
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), palette().color(QPalette::Base));
+        const QRect plot = rect().adjusted(56, 8, -8, -32);
+        if (plot.width() < 2 || plot.height() < 2) return;
+
+        // Limites: união das séries; a referência entra no intervalo de x delas
+        double x0 = INFINITY, x1 = -INFINITY, y0 = INFINITY, y1 = -INFINITY;
+        for (const Curve &c : m_curves) {
+            for (const DecimatedSeries::Bucket &b : c.series.buckets()) {
+                x0 = std::min(x0, b.xFirst);
+                x1 = std::max(x1, b.xLast);
+                y0 = std::min(y0, b.yMin);
+                y1 = std::max(y1, b.yMax);
             }
         }
-        // Se não encontrou, vai pro próximo ciclo
-        m_base += 210;
-        m_idx = 0;
-    }
+        painter.setPen(palette().color(QPalette::Mid));
+        painter.drawRect(plot);
+        if (x0 > x1) {
+            painter.setPen(palette().color(QPalette::Text));
+            painter.drawText(plot, Qt::AlignCenter, "sem dados");
+            return;
+        }
+        if (x1 <= x0) x1 = x0 + 1;
+
+        const int width = plot.width();
+        std::vector<double> reference;
+        if (m_reference) {
+            reference.resize(width + 1);
+            for (int col = 0; col <= width; ++col) {
+                reference[col] = m_reference(x0 + (x1 - x0) * col / width);
+                if (std::isfinite(reference[col])) {
+                    y0 = std::min(y0, reference[col]);
+                    y1 = std::max(y1, reference[col]);
+                }
+            }
+        }
+        if (y1 <= y0) { y0 -= 1; y1 += 1; }
+        const double pad = 0.05 * (y1 - y0);
+        y0 -= pad;
+        y1 += pad;
+
+        auto column = [&](double x) {
+            return std::clamp(static_cast<int>((x - x0) / (x1 - x0) * width), 0, width);
+        };
+        auto py = [&](double y) {
+            return plot.bottom() - (y - y0) / (y1 - y0) * plot.height();
+        };
+
+        // Eixos
+        painter.setPen(palette().color(QPalette::Text));
+        const QFontMetrics fm(font());
+        painter.drawText(QRect(0, plot.top(), 52, fm.height()), Qt::AlignRight,
+                         QString::number(y1, 'g', 4));
+        painter.drawText(QRect(0, plot.bottom() - fm.height(), 52, fm.height()), Qt::AlignRight,
+                         QString::number(y0, 'g', 4));
+        painter.drawText(QRect(plot.left(), plot.bottom() + 2, 80, fm.height()), Qt::AlignLeft,
+                         QString::number(x0, 'g', 4));
+        painter.drawText(QRect(plot.right() - 80, plot.bottom() + 2, 80, fm.height()), Qt::AlignRight,
+                         QString::number(x1, 'g', 4));
+        painter.drawText(QRect(plot.left(), plot.bottom() + 2 + fm.height(), width, fm.height()),
+                         Qt::AlignHCenter, m_xLabel);
+        painter.save();
+        painter.translate(fm.height(), plot.center().y());
+        painter.rotate(-90);
+        painter.drawText(QRect(-plot.height() / 2, -fm.height(), plot.height(), fm.height()),
+                         Qt::AlignHCenter, m_yLabel);
+        painter.restore();
+
+        painter.setClipRect(plot);
+        painter.setRenderHint(QPainter::Antialiasing, false);
+
+        if (!reference.empty()) {
+            QPolygonF line;
+            for (int col = 0; col <= width; ++col)
+                if (std::isfinite(reference[col]))
+                    line << QPointF(plot.left() + col, py(reference[col]));
+            painter.setPen(QPen(palette().color(QPalette::Mid), 1, Qt::DashLine));
+            painter.drawPolyline(line);
+        }
 
-    uint64_t current() const {
-        return m_base + Constants::WHEEL_OFFSETS[m_idx];
-    }
+        // Cada série: envelope e último y por coluna
+        struct Column { double lo, hi, last; bool used; };
+        std::vector<Column> columns(width + 1);
+        for (const Curve &c : m_curves) {
+            std::fill(columns.begin(), columns.end(), Column{0, 0, 0, false});
+            for (const DecimatedSeries::Bucket &b : c.series.buckets()) {
+                Column &col = columns[column(b.xLast)];
+                col.lo = col.used ? std::min(col.lo, b.yMin) : b.yMin;
+                col.hi = col.used ? std::max(col.hi, b.yMax) : b.yMax;
+                col.last = b.yLast;
+                col.used = true;
+            }
+            painter.setPen(QPen(c.color, c.dots ? 3 : 1));
+            QPolygonF line;
+            for (int i = 0; i <= width; ++i) {
+                if (!columns[i].used) continue;
+                const double x = plot.left() + i;
+                if (c.dots || columns[i].hi > columns[i].lo)
+                    painter.drawLine(QPointF(x, py(columns[i].lo)), QPointF(x, py(columns[i].hi)));
+                line << QPointF(x, py(columns[i].last));
+            }
+            if (!c.dots) painter.drawPolyline(line);
+        }
 
-    void next() {
-        ++m_idx;
-        if (m_idx >= Constants::WHEEL_SIZE) {
-            m_idx = 0;
-            m_base += 210;
+        // Legenda
+        painter.setClipping(false);
+        int y = plot.top() + 4;
+        for (const Curve &c : m_curves) {
+            painter.setPen(c.color);
+            painter.drawText(plot.left() + 6, y + fm.ascent(), c.name);
+            y += fm.height();
+        }
+        if (m_reference) {
+            painter.setPen(palette().color(QPalette::Text));
+            painter.drawText(plot.left() + 6, y + fm.ascent(), "- - " + m_referenceName);
         }
     }
 
 private:
-    uint64_t m_base;
-    int m_idx;
-};
+    struct Curve {
+        QString name;
+        QColor color;
+        bool dots;
+        DecimatedSeries series;
+    };
 
-// ======================= WORKER =======================
+    QString m_xLabel, m_yLabel;
+    std::vector<Curve> m_curves;
+    QString m_referenceName;
+    std::function<double(double)> m_reference;
+};
 
-class Worker : public QObject
+// Histogramas de v₂(p+1) e v₂(gap) lado a lado, contra a geométrica 2⁻ᵏ
+// (o último bin é k ≥ 8, com P = 2⁻⁷)
+class V2Chart : public QWidget
 {
-    Q_OBJECT
 public:
-    explicit Worker(QObject *parent = nullptr)
-        : QObject(parent), m_sieve(10000000)
+    explicit V2Chart(QWidget *parent = nullptr) : QWidget(parent) { setMinimumHeight(180); }
+
+    void setHistograms(const uint64_t (&v2)[8], const uint64_t (&v2Gap)[8])
     {
-        m_stopRequested.store(false);
+        std::copy(std::begin(v2), std::end(v2), m_counts[0]);
+        std::copy(std::begin(v2Gap), std::end(v2Gap), m_counts[1]);
+        update();
     }
 
-    void configure(uint64_t startN, AnalysisMode mode, bool multiThread)
+    void clear()
     {
-        m_startN = std::max(startN, uint64_t(3));
-        m_mode = mode;
-        m_multiThread = multiThread;
+        std::fill(&m_counts[0][0], &m_counts[0][0] + 16, 0);
+        update();
     }
 
-public slots:
-    void process()
+protected:
+    void paintEvent(QPaintEvent *) override
     {
-        using namespace Constants;
-
-        WheelIterator wheel(m_startN);
-
-        // Contadores primos
-        uint64_t lastPrime = 0;
-        uint64_t primeCount = 0;
-        long double sumPrimeGaps = 0.0L;
-
-        // Twins
-        uint64_t lastTwinP = 0;
-        int lastTwinClass = -1;
-        uint64_t twinCount = 0;
-        long double sumTwinGaps = 0.0L;
-        long double sumTwinExcess = 0.0L;
-
-        // Regime assintótico (p > 100k)
-        uint64_t asymptoticCount = 0;
-        long double sumAsymptoticExcess = 0.0L;
-
-        // v₂ stats
-        long double sumV2 = 0.0L;
-        uint64_t countV2 = 0;
-        uint64_t v2Histogram[8] = {0};
-
-        // v₂(gap) stats
-        long double sumV2Gap = 0.0L;
-        uint64_t countV2Gap = 0;
-        uint64_t v2GapHistogram[8] = {0};
-
-        // Correlação v₂(p+1) vs v₂(gap)
-        long double sumV2Product = 0.0L;
-        long double sumV2Sq = 0.0L;
-        long double sumV2GapSq = 0.0L;
-
-        // Transições mod 30
-        TransitionStats transitions;
-
-        // Décadas
-        DecadeStats decades[Stats::N_DECADES];
-
-        Stats stats;
-
-        const uint64_t progressStep = 5000;
-        uint64_t primesSinceLastUpdate = 0;
-
-        while (!m_stopRequested.load()) {
-            uint64_t n = wheel.current();
-            wheel.next();
-
-            // Usa teste otimizado: n já é coprimo com 2,3,5,7 pelo wheel 210
-            if (!m_sieve.isPrimeFromWheel(n))
-                continue;
-
-            ++primeCount;
-
-            // v₂(p+1)
-            unsigned k = v2_of(n + 1);
-            sumV2 += k;
-            ++countV2;
-            if (k >= 1 && k <= 7)
-                v2Histogram[k - 1]++;
-            else if (k >= 8)
-                v2Histogram[7]++;
-
-            // Gap de primos
-            if (lastPrime != 0) {
-                uint64_t gap = n - lastPrime;
-                sumPrimeGaps += gap;
-
-                // Twin?
-                if (gap == 2) {
-                    uint64_t twinP = lastPrime;
-                    int twinClass = classIndex(twinP);
-
-                    if (twinClass >= 0) {
-                        ++twinCount;
-
-                        if (lastTwinP != 0 && lastTwinClass >= 0) {
-                            uint64_t twinGap = twinP - lastTwinP;
-                            int gapMin = GAP_MIN[lastTwinClass][twinClass];
-                            int64_t excess = twinGap - gapMin;
-
-                            sumTwinGaps += twinGap;
-                            sumTwinExcess += excess;
-
-                            // v₂(gap) - trailing zeros do gap
-                            unsigned v2_gap = v2_of(twinGap);
-                            sumV2Gap += v2_gap;
-                            ++countV2Gap;
-
-                            if (v2_gap >= 1 && v2_gap <= 7)
-                                v2GapHistogram[v2_gap - 1]++;
-                            else if (v2_gap >= 8)
-                                v2GapHistogram[7]++;
-
-                            // Para correlação: usa v₂(p+1) do twin anterior
-                            unsigned v2_prev = v2_of(lastTwinP + 1);
-                            sumV2Product += v2_prev * v2_gap;
-                            sumV2Sq += v2_prev * v2_prev;
-                            sumV2GapSq += v2_gap * v2_gap;
-
-                            // Década (índice = log10(p) - 3)
-                            if (lastTwinP >= 1000) {
-                                int decIdx = static_cast<int>(std::log10(static_cast<double>(lastTwinP))) - 3;
-                                if (decIdx >= 0 && decIdx < Stats::N_DECADES) {
-                                    long double ln_p = std::log(static_cast<long double>(lastTwinP));
-                                    long double ln2_p = ln_p * ln_p;
-                                    decades[decIdx].count++;
-                                    decades[decIdx].sumExcess += excess;
-                                    decades[decIdx].sumLn2 += ln2_p;
-                                }
-                            }
-
-                            // Assintótico (p > 100k)
-                            if (lastTwinP > ASYMPTOTIC_LIMIT) {
-                                ++asymptoticCount;
-                                sumAsymptoticExcess += excess;
-                            }
-
-                            // Transições
-                            transitions.count[lastTwinClass][twinClass]++;
-                            transitions.sumGap[lastTwinClass][twinClass] += twinGap;
-                        }
-
-                        lastTwinP = twinP;
-                        lastTwinClass = twinClass;
-                    }
-                }
-            }
-            lastPrime = n;
-            ++primesSinceLastUpdate;
-
-            // Atualiza stats
-            if (primesSinceLastUpdate >= progressStep) {
-                primesSinceLastUpdate = 0;
-
-                stats.currentN = n;
-                stats.primeCount = primeCount;
-                stats.twinCount = twinCount;
-
-                long double ln_p = std::log(static_cast<long double>(n));
-                long double ln2_p = ln_p * ln_p;
-
-                // Regime
-                if (n < FROZEN_LIMIT) {
-                    stats.regime = Regime::Frozen;
-                } else if (n < TRANSITION_LIMIT) {
-                    stats.regime = Regime::Transition;
-                } else if (n < PRECISE_LIMIT) {
-                    stats.regime = Regime::Asymptotic;
-                } else {
-                    stats.regime = Regime::Precise;
-                }
-
-                // kT Primos: kT = ⟨gap⟩ - 2
-                if (primeCount > 1) {
-                    stats.avgPrimeGap = static_cast<double>(sumPrimeGaps / (primeCount - 1));
-                    stats.kTPrimeEmpirical = stats.avgPrimeGap - OFFSET_PRIMES;
-                }
-                stats.kTPrimeTheoretical = static_cast<double>(ln_p) - OFFSET_PRIMES;
-
-                // kT Twins
-                if (twinCount > 1) {
-                    uint64_t nTrans = twinCount - 1;
-                    stats.avgTwinGap = static_cast<double>(sumTwinGaps / nTrans);
-                    stats.kTTwinEmpirical = static_cast<double>(sumTwinExcess / nTrans);
-                }
-
-                stats.asymptoticCount = asymptoticCount;
-                if (asymptoticCount > 10) {
-                    stats.kTTwinAsymptotic = static_cast<double>(sumAsymptoticExcess / asymptoticCount);
-                }
-
-                // Modelo CUMULATIVO: kT = 0.7784×ln²(p) - 2.32×ln(p) - 13.9
-                stats.kTTwinTheoretical = static_cast<double>(
-                    kT_CUM_LN2 * ln2_p + kT_CUM_LN * ln_p + kT_CUM_C
-                );
-
-                // Razão kT/ln²(p)
-                if (ln2_p > 0 && stats.kTTwinAsymptotic > 0) {
-                    stats.kTRatio = stats.kTTwinAsymptotic / static_cast<double>(ln2_p);
-                }
-
-                // v₂(p+1)
-                if (countV2 > 0) {
-                    stats.meanV2 = static_cast<double>(sumV2 / countV2);
-                    for (int i = 0; i < 8; ++i)
-                        stats.v2Histogram[i] = v2Histogram[i];
-                }
-
-                // v₂(gap)
-                if (countV2Gap > 0) {
-                    stats.meanV2Gap = static_cast<double>(sumV2Gap / countV2Gap);
-                    for (int i = 0; i < 8; ++i)
-                        stats.v2GapHistogram[i] = v2GapHistogram[i];
-                }
-
-                // Correlação de Pearson entre v₂(p+1) e v₂(gap)
-                if (countV2Gap > 10) {
-                    double n = static_cast<double>(countV2Gap);
-                    double meanP = static_cast<double>(sumV2 / countV2);
-                    double meanG = static_cast<double>(sumV2Gap / countV2Gap);
-
-                    // r = Cov(X,Y) / sqrt(Var(X) × Var(Y))
-                    double cov = (static_cast<double>(sumV2Product) / n) - (meanP * meanG);
-                    double varP = (static_cast<double>(sumV2Sq) / n) - (meanP * meanP);
-                    double varG = (static_cast<double>(sumV2GapSq) / n) - (meanG * meanG);
-
-                    if (varP > 0 && varG > 0) {
-                        stats.corrV2 = cov / std::sqrt(varP * varG);
-                    }
-                }
-
-                // Transições
-                stats.transitions = transitions;
-
-                // R² de Boltzmann: consistência de kT entre transições
-                if (twinCount > 100) {
-                    double kT_mean = stats.kTTwinEmpirical;
-                    if (kT_mean > 0) {
-                        double ssRes = 0, ssTot = 0;
-                        int validCount = 0;
-
-                        for (int c1 = 0; c1 < 3; ++c1) {
-                            for (int c2 = 0; c2 < 3; ++c2) {
-                                if (transitions.count[c1][c2] < 10) continue;
-                                double avgGap = transitions.avgGap(c1, c2);
-                                int gapMin = GAP_MIN[c1][c2];
-                                double kT_trans = avgGap - gapMin;
-
-                                ssRes += (kT_trans - kT_mean) * (kT_trans - kT_mean);
-                                ssTot += kT_trans * kT_trans;
-                                ++validCount;
-                            }
-                        }
-
-                        if (validCount > 1 && ssTot > 0) {
-                            stats.boltzmannR2 = 1.0 - ssRes / ssTot;
-                        }
-                    }
-                }
-
-                // Décadas
-                for (int i = 0; i < Stats::N_DECADES; ++i) {
-                    stats.decades[i] = decades[i];
-                }
-
-                emit progress(stats);
+        QPainter painter(this);
+        painter.fillRect(rect(), palette().color(QPalette::Base));
+        const QFontMetrics fm(font());
+        const QRect plot = rect().adjusted(8, fm.height() + 8, -8, -fm.height() - 6);
+        if (plot.width() < 16 || plot.height() < 2) return;
+
+        static const QColor colors[2] = {QColor(40, 90, 200), QColor(200, 90, 40)};
+        static const char *const names[2] = {"v₂(p+1)", "v₂(gap)"};
+        double total[2] = {0, 0};
+        for (int h = 0; h < 2; ++h)
+            for (uint64_t c : m_counts[h]) total[h] += static_cast<double>(c);
+
+        const double slot = plot.width() / 8.0;
+        const double bar = slot * 0.35;
+        auto py = [&](double fraction) { return plot.bottom() - fraction / 0.55 * plot.height(); };
+        for (int k = 0; k < 8; ++k) {
+            const double x = plot.left() + k * slot + slot * 0.15;
+            for (int h = 0; h < 2; ++h) {
+                if (total[h] == 0) continue;
+                const double fraction = m_counts[h][k] / total[h];
+                painter.fillRect(QRectF(x + h * bar, py(fraction), bar, plot.bottom() - py(fraction)),
+                                 colors[h]);
             }
+            const double expected = std::ldexp(1.0, -std::min(k + 1, 7));
+            painter.setPen(QPen(palette().color(QPalette::Text), 1, Qt::DashLine));
+            painter.drawLine(QPointF(x - slot * 0.05, py(expected)), QPointF(x + 2 * bar + slot * 0.05, py(expected)));
+            painter.drawText(QRectF(plot.left() + k * slot, plot.bottom() + 2, slot, fm.height()),
+                             Qt::AlignHCenter, k < 7 ? QString("k=%1").arg(k + 1) : QString("k≥8"));
         }
 
-        emit finished();
+        int x = plot.left();
+        for (int h = 0; h < 2; ++h) {
+            painter.setPen(colors[h]);
+            painter.drawText(x, 4 + fm.ascent(), names[h]);
+            x += fm.horizontalAdvance(names[h]) + 12;
+        }
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(x, 4 + fm.ascent(), "- - 2⁻ᵏ");
     }
 
-    void stop() { m_stopRequested.store(true); }
-
-signals:
-    void progress(const Stats &stats);
-    void finished();
-
 private:
-    std::atomic<bool> m_stopRequested;
-    uint64_t m_startN = 3;
-    AnalysisMode m_mode = AnalysisMode::Both;
-    bool m_multiThread = false;
-    PrimeSieve m_sieve;
+    uint64_t m_counts[2][8] = {};
 };
 
 // ======================= JANELA PRINCIPAL =======================
@@ -660,7 +402,6 @@ public:
     MainWindow(QWidget *parent = nullptr)
         : QMainWindow(parent)
     {
-        qRegisterMetaType<Stats>("Stats");
         setWindowTitle("Termodinâmica dos Primos v4.1");
 
         QWidget *central = new QWidget(this);
@@ -679,21 +420,31 @@ public:
         m_modeCombo->addItem("Twins", static_cast<int>(AnalysisMode::Twins));
         m_modeCombo->addItem("Ambos", static_cast<int>(AnalysisMode::Both));
         m_modeCombo->setCurrentIndex(2);
+        m_multiThreadCheck = new QCheckBox(
+            QString("Multi-thread (%1 núcleos)").arg(std::thread::hardware_concurrency()), configBox);
+        m_exportCheck = new QCheckBox("Exportar twins (um registro por par)", configBox);
+        m_exportCheck->setToolTip("Grava p, classe mod 30, v₂(p+1) e gap de cada twin em " + twinExportPath());
 
         m_startButton = new QPushButton("▶ Start", configBox);
         m_stopButton = new QPushButton("⬛ Stop", configBox);
         m_resetButton = new QPushButton("↺ Reset", configBox);
+        m_resumeButton = new QPushButton("⏵ Retomar", configBox);
+        m_resumeButton->setToolTip("Continua a varredura do último checkpoint salvo");
         m_stopButton->setEnabled(false);
+        m_resumeButton->setEnabled(QFile::exists(checkpointPath()));
 
         cfg->addWidget(new QLabel("Início n:"), 0, 0);
         cfg->addWidget(m_startEdit, 0, 1);
         cfg->addWidget(new QLabel("Modo:"), 1, 0);
         cfg->addWidget(m_modeCombo, 1, 1);
+        cfg->addWidget(m_multiThreadCheck, 2, 0, 1, 2);
+        cfg->addWidget(m_exportCheck, 3, 0, 1, 2);
         auto *btnLayout = new QHBoxLayout();
         btnLayout->addWidget(m_startButton);
         btnLayout->addWidget(m_stopButton);
         btnLayout->addWidget(m_resetButton);
-        cfg->addLayout(btnLayout, 2, 0, 1, 2);
+        btnLayout->addWidget(m_resumeButton);
+        cfg->addLayout(btnLayout, 4, 0, 1, 2);
 
         // Contagens
         auto *statsBox = new QGroupBox("Contagens", central);
@@ -705,6 +456,17 @@ public:
         statsLayout->addRow("π(n):", m_labelPrimeCount);
         statsLayout->addRow("π₂(n):", m_labelTwinCount);
 
+        // π(x) combinatório (LMO): confere π(n) ou vai além da varredura
+        m_piEdit = new QLineEdit(statsBox);
+        m_piEdit->setPlaceholderText("x (vazio = n atual)");
+        m_piButton = new QPushButton("Calcular", statsBox);
+        m_labelPiLmo = new QLabel("-");
+        auto *piLayout = new QHBoxLayout();
+        piLayout->addWidget(m_piEdit);
+        piLayout->addWidget(m_piButton);
+        statsLayout->addRow("π(x) LMO:", piLayout);
+        statsLayout->addRow("", m_labelPiLmo);
+
         // kT Primos
         auto *primeBox = new QGroupBox("kT Primos (|H|=1)", central);
         auto *primeLayout = new QFormLayout(primeBox);
@@ -795,11 +557,29 @@ public:
         v2Layout->addWidget(m_labelCorrV2, 7, 1, 1, 2);
         v2Layout->addWidget(new QLabel("→ 0"), 7, 3);
 
+        // Gaps máximos: recorde atual e maior razão de Cramér-Shanks-Granville
+        auto *recordBox = new QGroupBox("Gaps Máximos (Cramér)", central);
+        auto *recordLayout = new QGridLayout(recordBox);
+        recordLayout->addWidget(new QLabel(""), 0, 0);
+        recordLayout->addWidget(new QLabel("<b>recorde</b>"), 0, 1);
+        recordLayout->addWidget(new QLabel("<b>em p</b>"), 0, 2);
+        recordLayout->addWidget(new QLabel("<b>gap/ln²p</b>"), 0, 3);
+        recordLayout->addWidget(new QLabel("<b>máx razão</b>"), 0, 4);
+        const char *recordRows[2] = {"Primos:", "Twins:"};
+        for (int row = 0; row < 2; ++row) {
+            recordLayout->addWidget(new QLabel(recordRows[row]), row + 1, 0);
+            for (int col = 0; col < 4; ++col) {
+                m_recordLabels[row][col] = new QLabel("-");
+                recordLayout->addWidget(m_recordLabels[row][col], row + 1, col + 1);
+            }
+        }
+
         leftColumn->addWidget(configBox);
         leftColumn->addWidget(statsBox);
         leftColumn->addWidget(primeBox);
         leftColumn->addWidget(twinBox);
         leftColumn->addWidget(v2Box);
+        leftColumn->addWidget(recordBox);
         leftColumn->addStretch();
 
         // === COLUNA CENTRAL ===
@@ -809,17 +589,11 @@ public:
         auto *convBox = new QGroupBox("kT Local por Década (Hardy-Littlewood)", central);
         auto *convLayout = new QVBoxLayout(convBox);
 
-        m_convergenceTable = new QTableWidget(8, 5, convBox);
+        // Uma linha por década (10³ ... 10¹⁰ de início; cresce com a varredura)
+        m_convergenceTable = new QTableWidget(0, 5, convBox);
         m_convergenceTable->setHorizontalHeaderLabels({"Déc", "n", "kT", "obs/teo (err%)", "Trend"});
-        QStringList decLabels = {"10³", "10⁴", "10⁵", "10⁶", "10⁷", "10⁸", "10⁹", "10¹⁰"};
-        for (int i = 0; i < 8; ++i) {
-            m_convergenceTable->setItem(i, 0, new QTableWidgetItem(decLabels[i]));
-            for (int j = 1; j < 5; ++j) {
-                auto *item = new QTableWidgetItem("-");
-                item->setTextAlignment(Qt::AlignCenter);
-                m_convergenceTable->setItem(i, j, item);
-            }
-        }
+        for (int i = 0; i < 8; ++i)
+            ensureConvergenceRow(i);
         m_convergenceTable->setColumnWidth(0, 40);
         m_convergenceTable->setColumnWidth(1, 60);
         m_convergenceTable->setColumnWidth(2, 50);
@@ -859,10 +633,25 @@ public:
         }
         m_gapTable->setMinimumHeight(100);
 
+        m_fitTable = new QTableWidget(3, 3, transBox);
+        m_fitTable->setHorizontalHeaderLabels({"→11", "→17", "→29"});
+        m_fitTable->setVerticalHeaderLabels({"11→", "17→", "29→"});
+        for (int i = 0; i < 3; ++i) {
+            m_fitTable->setColumnWidth(i, 70);
+            for (int j = 0; j < 3; ++j) {
+                auto *item = new QTableWidgetItem("-");
+                item->setTextAlignment(Qt::AlignCenter);
+                m_fitTable->setItem(i, j, item);
+            }
+        }
+        m_fitTable->setMinimumHeight(100);
+
         transLayout->addWidget(new QLabel("Probabilidades:"));
         transLayout->addWidget(m_transitionTable);
         transLayout->addWidget(new QLabel("⟨gap⟩ (gap_min):"));
         transLayout->addWidget(m_gapTable);
+        transLayout->addWidget(new QLabel("kT MLE ± IC 95% (χ² na dica):"));
+        transLayout->addWidget(m_fitTable);
 
         m_labelBoltzmannR2 = new QLabel("R² Boltzmann: -");
         transLayout->addWidget(m_labelBoltzmannR2);
@@ -913,6 +702,45 @@ C₂ = 0.6601618
 </pre>
 )");
 
+        // Perfil: contadores e cronômetros de fase do motor (Profile)
+        auto *profileBox = new QGroupBox("Perfil", central);
+        auto *profileLayout = new QFormLayout(profileBox);
+        m_labelCandidateRate = new QLabel("-");
+        m_labelPrimeRate = new QLabel("-");
+        m_labelTwinRate = new QLabel("-");
+        m_labelProgressRate = new QLabel("-");
+        m_labelPhases = new QLabel("-");
+        m_labelMillerRabin = new QLabel("-");
+        m_labelPhases->setWordWrap(true);
+        m_labelMillerRabin->setWordWrap(true);
+        profileLayout->addRow("candidatos/s:", m_labelCandidateRate);
+        profileLayout->addRow("primos/s:", m_labelPrimeRate);
+        profileLayout->addRow("twins/s:", m_labelTwinRate);
+        profileLayout->addRow("progresso:", m_labelProgressRate);
+        profileLayout->addRow("fases:", m_labelPhases);
+        profileLayout->addRow("Miller-Rabin:", m_labelMillerRabin);
+        if (!Profile::enabled())
+            m_labelPhases->setText("desligado (THERMO_PROFILE=0)");
+
+        // Gráficos de convergência, alimentados pelos snapshots
+        auto *chartTabs = new QTabWidget(central);
+        m_kTChart = new SeriesChart("ln²(p)", "kT", chartTabs);
+        m_kTChartBins = m_kTChart->addCurve("kT local (bins)", QColor(40, 90, 200), true);
+        m_kTChartTotal = m_kTChart->addCurve("kT total", QColor(200, 40, 40));
+        m_kTChart->setReference("0.75·ln²p − 17 (local)", [](double ln2) {
+            return Constants::kT_LOC_LN2 * ln2 + Constants::kT_LOC_LN * std::sqrt(ln2) + Constants::kT_LOC_C;
+        });
+        m_ratioChart = new SeriesChart("log₁₀ p", "kT/ln²(p)", chartTabs);
+        m_ratioChartBins = m_ratioChart->addCurve("bins", QColor(40, 90, 200), true);
+        m_ratioChartAsymptotic = m_ratioChart->addCurve("p > 100k", QColor(200, 40, 40));
+        m_ratioChart->setReference("1/(2C₂)", [](double) { return Constants::RATIO_THEORETICAL; });
+        m_v2Chart = new V2Chart(chartTabs);
+        chartTabs->addTab(m_kTChart, "kT × ln²p");
+        chartTabs->addTab(m_ratioChart, "razão × p");
+        chartTabs->addTab(m_v2Chart, "v₂");
+
+        rightColumn->addWidget(profileBox);
+        rightColumn->addWidget(chartTabs, 3);
         rightColumn->addWidget(new QLabel("Log:"));
         rightColumn->addWidget(m_log, 2);
         rightColumn->addWidget(new QLabel("Teoria:"));
@@ -927,6 +755,11 @@ C₂ = 0.6601618
         connect(m_startButton, &QPushButton::clicked, this, &MainWindow::onStart);
         connect(m_stopButton, &QPushButton::clicked, this, &MainWindow::onStop);
         connect(m_resetButton, &QPushButton::clicked, this, &MainWindow::onReset);
+        connect(m_resumeButton, &QPushButton::clicked, this, &MainWindow::onResume);
+        connect(m_piButton, &QPushButton::clicked, this, &MainWindow::onComputePi);
+
+        m_refreshTimer = new QTimer(this);
+        connect(m_refreshTimer, &QTimer::timeout, this, &MainWindow::pollProgress);
     }
 
     ~MainWindow() override { cleanupWorker(); }
@@ -946,30 +779,38 @@ private slots:
             return;
         }
 
-        m_workerThread = new QThread(this);
-        m_worker = new Worker();
-        m_worker->configure(startN,
-            static_cast<AnalysisMode>(m_modeCombo->currentData().toInt()),
-            false);
-        m_worker->moveToThread(m_workerThread);
-
-        connect(m_workerThread, &QThread::started, m_worker, &Worker::process);
-        connect(m_worker, &Worker::progress, this, &MainWindow::onProgress, Qt::QueuedConnection);
-        connect(m_worker, &Worker::finished, this, &MainWindow::onFinished, Qt::QueuedConnection);
-        connect(m_worker, &Worker::finished, m_workerThread, &QThread::quit);
-        connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
-        connect(m_workerThread, &QThread::finished, m_workerThread, &QObject::deleteLater);
-        connect(m_workerThread, &QThread::finished, this, [this]() {
-            m_workerThread = nullptr;
-            m_worker = nullptr;
-        });
+        if (QFile::exists(checkpointPath())
+            && QMessageBox::question(this, "Checkpoint",
+                   "Uma nova varredura substitui o checkpoint salvo. Continuar?")
+               != QMessageBox::Yes)
+            return;
 
-        m_workerThread->start();
-        m_startButton->setEnabled(false);
-        m_stopButton->setEnabled(true);
+        m_runMode = static_cast<AnalysisMode>(m_modeCombo->currentData().toInt());
+        startWorker(nullptr, startN);
         m_log->append(QString("▶ Iniciando de n=%1").arg(startN));
     }
 
+    void onResume()
+    {
+        if (m_workerThread) {
+            m_log->append("⚠ Já rodando.");
+            return;
+        }
+
+        ScanCheckpoint ckpt;
+        std::string error;
+        if (!ckpt.load(checkpointPath().toStdString(), &error)) {
+            QMessageBox::warning(this, "Erro", "Não foi possível retomar: " + QString::fromStdString(error));
+            return;
+        }
+
+        m_startEdit->setText(QString::number(ckpt.startN));
+        m_modeCombo->setCurrentIndex(m_modeCombo->findData(static_cast<int>(ckpt.mode)));
+        m_runMode = ckpt.mode;
+        startWorker(&ckpt, ckpt.startN);
+        m_log->append(QString("⏵ Retomando de n=%1 (início em %2)").arg(ckpt.nextN).arg(ckpt.startN));
+    }
+
     void onStop()
     {
         if (m_worker) m_worker->stop();
@@ -987,19 +828,64 @@ private slots:
         m_log->append("↺ Reset");
     }
 
+    // π(x) numa thread própria; o resultado volta pelo finished da QThread
+    void onComputePi()
+    {
+        if (m_piThread) {
+            m_log->append("⚠ π(x) já em cálculo.");
+            return;
+        }
+        bool ok = true;
+        const uint64_t x = m_piEdit->text().isEmpty() ? m_lastCurrentN
+                                                       : m_piEdit->text().toULongLong(&ok);
+        if (!ok || x == 0) {
+            QMessageBox::warning(this, "Erro", "x inválido");
+            return;
+        }
+
+        auto counter = std::make_shared<PrimeCounter>();
+        auto result = std::make_shared<std::pair<uint64_t, double>>();
+        m_piCounter = counter;
+        m_piThread = QThread::create([counter, result, x] {
+            const auto t0 = std::chrono::steady_clock::now();
+            result->first = counter->count(x);
+            result->second = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        });
+        m_piThread->setParent(this);
+        connect(m_piThread, &QThread::finished, this, [this, result, x] {
+            showPrimePi(x, result->first, result->second);
+            m_piThread->deleteLater();
+            m_piThread = nullptr;
+            m_piCounter.reset();
+            m_piButton->setEnabled(true);
+        });
+        m_piButton->setEnabled(false);
+        m_labelPiLmo->setText(QString("calculando π(%1)...").arg(x));
+        m_piThread->start();
+    }
+
     void onProgress(const Stats &s)
     {
+        const bool hasPrimes = m_runMode != AnalysisMode::Twins;
+        const bool hasTwins = m_runMode != AnalysisMode::Primes;
+        m_lastCurrentN = s.currentN;
+        m_lastPrimeCount = s.primeCount;
+
         m_labelCurrentN->setText(QString::number(s.currentN));
-        m_labelPrimeCount->setText(QString::number(s.primeCount));
-        m_labelTwinCount->setText(QString::number(s.twinCount));
+        if (hasPrimes)
+            m_labelPrimeCount->setText(QString::number(s.primeCount));
+        if (hasTwins)
+            m_labelTwinCount->setText(QString::number(s.twinCount));
 
         // Primos
-        m_labelAvgPrimeGap->setText(QString::number(s.avgPrimeGap, 'f', 3));
-        m_labelkTPrimeEmp->setText(QString::number(s.kTPrimeEmpirical, 'f', 3));
-        m_labelkTPrimeTheo->setText(QString::number(s.kTPrimeTheoretical, 'f', 3));
-        if (s.kTPrimeTheoretical > 0) {
-            double err = 100.0 * std::abs(s.kTPrimeEmpirical - s.kTPrimeTheoretical) / s.kTPrimeTheoretical;
-            m_labelkTPrimeError->setText(QString("%1%").arg(err, 0, 'f', 2));
+        if (hasPrimes) {
+            m_labelAvgPrimeGap->setText(QString::number(s.avgPrimeGap, 'f', 3));
+            m_labelkTPrimeEmp->setText(QString::number(s.kTPrimeEmpirical, 'f', 3));
+            m_labelkTPrimeTheo->setText(QString::number(s.kTPrimeTheoretical, 'f', 3));
+            if (s.kTPrimeTheoretical > 0) {
+                double err = 100.0 * std::abs(s.kTPrimeEmpirical - s.kTPrimeTheoretical) / s.kTPrimeTheoretical;
+                m_labelkTPrimeError->setText(QString("%1%").arg(err, 0, 'f', 2));
+            }
         }
 
         // Regime com cor
@@ -1007,19 +893,21 @@ private slots:
         m_labelRegime->setStyleSheet(QString("font-weight: bold; color: %1;").arg(regimeColor(s.regime)));
 
         // Twins
-        m_labelAvgTwinGap->setText(QString::number(s.avgTwinGap, 'f', 1));
-        m_labelkTTwinEmp->setText(QString::number(s.kTTwinEmpirical, 'f', 1));
+        if (hasTwins) {
+            m_labelAvgTwinGap->setText(QString::number(s.avgTwinGap, 'f', 1));
+            m_labelkTTwinEmp->setText(QString::number(s.kTTwinEmpirical, 'f', 1));
+            m_labelkTTwinTheo->setText(QString::number(s.kTTwinTheoretical, 'f', 1));
+            m_labelMeanV2Gap->setText(QString::number(s.meanV2Gap, 'f', 4));
+        }
 
-        if (s.asymptoticCount > 10) {
+        if (hasTwins && s.asymptoticCount > 10) {
             m_labelkTTwinAsymptotic->setText(QString("%1 (n=%2)")
                 .arg(s.kTTwinAsymptotic, 0, 'f', 1)
                 .arg(s.asymptoticCount));
-        } else {
+        } else if (hasTwins) {
             m_labelkTTwinAsymptotic->setText("aguardando...");
         }
 
-        m_labelkTTwinTheo->setText(QString::number(s.kTTwinTheoretical, 'f', 1));
-
         // Ratio com cor
         QString ratioColor = "black";
         double pct = s.kTRatio / Constants::RATIO_THEORETICAL;
@@ -1027,17 +915,18 @@ private slots:
         else if (pct > 0.85 && pct < 1.15) ratioColor = "orange";
         else if (s.kTRatio > 0) ratioColor = "red";
 
-        m_labelkTRatio->setText(QString::number(s.kTRatio, 'f', 4));
+        if (hasTwins)
+            m_labelkTRatio->setText(QString::number(s.kTRatio, 'f', 4));
         m_labelkTRatio->setStyleSheet(QString("font-weight: bold; color: %1;").arg(ratioColor));
 
-        if (s.kTTwinTheoretical > 0 && s.asymptoticCount > 10) {
+        if (hasTwins && s.kTTwinTheoretical > 0 && s.asymptoticCount > 10) {
             double err = 100.0 * std::abs(s.kTTwinAsymptotic - s.kTTwinTheoretical) / s.kTTwinTheoretical;
             m_labelkTTwinError->setText(QString("%1%").arg(err, 0, 'f', 2));
         }
 
         // v₂(p+1) e v₂(gap)
-        m_labelMeanV2->setText(QString::number(s.meanV2, 'f', 4));
-        m_labelMeanV2Gap->setText(QString::number(s.meanV2Gap, 'f', 4));
+        if (hasPrimes)
+            m_labelMeanV2->setText(QString::number(s.meanV2, 'f', 4));
 
         uint64_t totalV2 = 0, totalV2Gap = 0;
         for (int i = 0; i < 8; ++i) {
@@ -1051,22 +940,25 @@ private slots:
             m_labelV2P3->setText(QString::number(double(s.v2Histogram[2]) / totalV2, 'f', 3));
         }
 
-        if (totalV2Gap > 0) {
+        if (hasTwins && totalV2Gap > 0) {
             m_labelV2GapP1->setText(QString::number(double(s.v2GapHistogram[0]) / totalV2Gap, 'f', 3));
             m_labelV2GapP2->setText(QString::number(double(s.v2GapHistogram[1]) / totalV2Gap, 'f', 3));
             m_labelV2GapP3->setText(QString::number(double(s.v2GapHistogram[2]) / totalV2Gap, 'f', 3));
         }
 
         // Correlação com cor (verde se próximo de 0)
-        QString corrColor = std::abs(s.corrV2) < 0.05 ? "green" : "red";
-        m_labelCorrV2->setText(QString("r = %1").arg(s.corrV2, 0, 'f', 4));
-        m_labelCorrV2->setStyleSheet(QString("font-weight: bold; color: %1;").arg(corrColor));
+        if (hasTwins) {
+            QString corrColor = std::abs(s.corrV2) < 0.05 ? "green" : "red";
+            m_labelCorrV2->setText(QString("r = %1").arg(s.corrV2, 0, 'f', 4));
+            m_labelCorrV2->setStyleSheet(QString("font-weight: bold; color: %1;").arg(corrColor));
+        }
 
         // Tabela de convergência por década (usando modelo LOCAL)
         double prevErrPct = -1;
-        for (int i = 0; i < Stats::N_DECADES; ++i) {
-            const auto& dec = s.decades[i];
+        for (int i = 0; i + LogBinLayout::FIRST_DECADE <= s.lastDecade(); ++i) {
+            const DecadeStats dec = s.decade(i + LogBinLayout::FIRST_DECADE);
             if (dec.count > 0) {
+                ensureConvergenceRow(i);
                 m_convergenceTable->item(i, 1)->setText(QString::number(dec.count));
 
                 double kT_obs = dec.kT();
@@ -1139,29 +1031,281 @@ private slots:
                 int gapMin = Constants::GAP_MIN[c1][c2];
                 m_gapTable->item(c1, c2)->setText(
                     QString("%1 (%2)").arg(avgGap, 0, 'f', 0).arg(gapMin));
+
+                const BoltzmannFit &fit = s.boltzmannFit[c1][c2];
+                QTableWidgetItem *fitItem = m_fitTable->item(c1, c2);
+                if (fit.kT <= 0) {
+                    fitItem->setText("-");
+                    fitItem->setToolTip(QString());
+                    continue;
+                }
+                fitItem->setText(QString("%1 ± %2").arg(fit.kT, 0, 'f', 0)
+                    .arg((fit.kTHigh - fit.kTLow) / 2, 0, 'f', 1));
+                fitItem->setToolTip(fit.dof > 0
+                    ? QString("n = %1\nIC 95%: [%2, %3]\nχ² = %4 (%5 gl)\np = %6")
+                        .arg(fit.count).arg(fit.kTLow, 0, 'f', 1).arg(fit.kTHigh, 0, 'f', 1)
+                        .arg(fit.chi2, 0, 'f', 1).arg(fit.dof).arg(fit.pValue, 0, 'g', 3)
+                    : QString("n = %1\nIC 95%: [%2, %3]\nχ²: bins insuficientes")
+                        .arg(fit.count).arg(fit.kTLow, 0, 'f', 1).arg(fit.kTHigh, 0, 'f', 1));
+                fitItem->setForeground(fit.dof > 0 && fit.pValue < 0.01 ? Qt::red : Qt::black);
             }
         }
 
-        m_labelBoltzmannR2->setText(QString("R² = %1").arg(s.boltzmannR2, 0, 'f', 4));
+        if (hasTwins)
+            m_labelBoltzmannR2->setText(QString("R² = %1").arg(s.boltzmannR2, 0, 'f', 4));
+
+        // Gaps máximos; cada recorde novo vai para o log
+        const GapRecords *records[2] = {&s.primeGapRecords, &s.twinGapRecords};
+        const char *recordNames[2] = {"primo", "twin"};
+        for (int row = 0; row < 2; ++row) {
+            const std::vector<GapRecord> &list = records[row]->records;
+            if (list.empty() || (row == 1 && !hasTwins)) continue;
+            const GapRecord &last = list.back();
+            const GapRecord best = records[row]->maxRatio();
+            m_recordLabels[row][0]->setText(QString::number(last.gap));
+            m_recordLabels[row][1]->setText(QString::number(last.p));
+            m_recordLabels[row][2]->setText(QString::number(last.cramerRatio(), 'f', 4));
+            m_recordLabels[row][3]->setText(QString("%1 (p=%2)").arg(best.cramerRatio(), 0, 'f', 4).arg(best.p));
+
+            // Os recordes que já existiam no primeiro snapshot não são logados
+            if (m_recordsLogged[row] == SIZE_MAX) m_recordsLogged[row] = list.size();
+            for (size_t i = m_recordsLogged[row]; i < list.size(); ++i)
+                m_log->append(QString("recorde de gap %1: %2 em p=%3 | gap/ln²p=%4")
+                    .arg(recordNames[row]).arg(list[i].gap).arg(list[i].p)
+                    .arg(list[i].cramerRatio(), 0, 'f', 4));
+            m_recordsLogged[row] = list.size();
+        }
 
-        // Log periódico
-        if ((s.primeCount % 100000) < 5000) {
-            m_log->append(QString("n=%1 | π₂=%2 | kT=%3 | ratio=%4")
-                .arg(s.currentN)
-                .arg(s.twinCount)
-                .arg(s.kTTwinAsymptotic, 0, 'f', 1)
-                .arg(s.kTRatio, 0, 'f', 4));
+        updateCharts(s);
+
+        // Log periódico: a cada 100k primos (ou 100k twins no modo Twins)
+        const uint64_t logBlock = (hasPrimes ? s.primeCount : s.twinCount) / 100000;
+        if (logBlock != m_lastLogBlock) {
+            m_lastLogBlock = logBlock;
+            if (!hasTwins)
+                m_log->append(QString("n=%1 | π=%2").arg(s.currentN).arg(s.primeCount));
+            else
+                m_log->append(QString("n=%1 | π₂=%2 | kT=%3 | ratio=%4")
+                    .arg(s.currentN)
+                    .arg(s.twinCount)
+                    .arg(s.kTTwinAsymptotic, 0, 'f', 1)
+                    .arg(s.kTRatio, 0, 'f', 4));
+        }
+    }
+
+    // Um ponto por snapshot nas séries do fluxo (memória fixa em
+    // DecimatedSeries); as dos bins são refeitas, limitadas pelo layout
+    void updateCharts(const Stats &s)
+    {
+        if (s.currentN > 1) {
+            const double ln = std::log(static_cast<double>(s.currentN));
+            if (s.twinCount > 1)
+                m_kTChart->series(m_kTChartTotal).append(ln * ln, s.kTTwinEmpirical);
+            if (s.kTRatio > 0)
+                m_ratioChart->series(m_ratioChartAsymptotic).append(std::log10(static_cast<double>(s.currentN)), s.kTRatio);
+        }
+
+        DecimatedSeries &kTBins = m_kTChart->series(m_kTChartBins);
+        DecimatedSeries &ratioBins = m_ratioChart->series(m_ratioChartBins);
+        kTBins.clear();
+        ratioBins.clear();
+        for (int i = 0; i < static_cast<int>(s.bins.size()); ++i) {
+            const LogBin &b = s.bins[i];
+            if (b.count < CHART_MIN_BIN_COUNT) continue;
+            const double ln2 = s.binLayout->meanLn2(i);
+            kTBins.append(ln2, b.kT());
+            ratioBins.append(std::log10(static_cast<double>(s.binLayout->lower(i))), b.kT() / ln2);
         }
+
+        m_kTChart->update();
+        m_ratioChart->update();
+        m_v2Chart->setHistograms(s.v2Histogram, s.v2GapHistogram);
+    }
+
+    // Leitura periódica do snapshot publicado pelo Worker
+    void pollProgress()
+    {
+        if (!m_snapshots) return;
+        if (const Stats *s = m_snapshots->take()) {
+            ++m_snapshotsTaken;
+            onProgress(*s);
+        }
+        if (m_profileClock.elapsed() >= PROFILE_INTERVAL_MS)
+            updateProfile();
     }
 
     void onFinished()
     {
+        // O Worker publica o estado final antes de emitir finished
+        pollProgress();
+        updateProfile();
+        m_refreshTimer->stop();
+        m_snapshots.reset();
         m_log->append("✓ Finalizado.");
         m_startButton->setEnabled(true);
         m_stopButton->setEnabled(false);
+        m_resumeButton->setEnabled(QFile::exists(checkpointPath()));
     }
 
 private:
+    // Taxas desde a última atualização do painel de perfil e a divisão do
+    // tempo entre as fases (somada sobre as threads, desde o Start)
+    void updateProfile()
+    {
+        if (!Profile::enabled()) return;
+        const double dt = m_profileClock.restart() / 1000.0;
+        const Profile::Snapshot now = Profile::snapshot();
+        if (dt <= 0) return;
+        auto rate = [&](Profile::Counter c) {
+            return QString::number((now[c] - m_profileLast[c]) / dt, 'g', 4);
+        };
+        m_labelCandidateRate->setText(rate(Profile::CANDIDATES));
+        m_labelPrimeRate->setText(rate(Profile::PRIMES));
+        m_labelTwinRate->setText(rate(Profile::TWINS));
+        m_labelProgressRate->setText(QString("%1 Hz recebidos, %2 Hz publicados")
+            .arg((m_snapshotsTaken - m_snapshotsAtLast) / dt, 0, 'f', 1)
+            .arg((now[Profile::REPORTS] - m_profileLast[Profile::REPORTS]) / dt, 0, 'f', 1));
+        m_snapshotsAtLast = m_snapshotsTaken;
+
+        double total = 0;
+        for (int i = 0; i < Profile::PHASE_COUNT; ++i)
+            total += now.seconds(Profile::Phase(i));
+        QStringList phases;
+        for (int i = 0; i < Profile::PHASE_COUNT; ++i) {
+            const double t = now.seconds(Profile::Phase(i));
+            phases << QString("%1 %2%").arg(Profile::phaseName(i))
+                                        .arg(total > 0 ? 100 * t / total : 0.0, 0, 'f', 1);
+        }
+        m_labelPhases->setText(phases.join(" | "));
+
+        QStringList rejected;
+        for (int i = 0; i < Profile::MAX_WITNESSES; ++i)
+            rejected << QString::number(now.rejectedAt(i));
+        m_labelMillerRabin->setText(QString("%1 testes; compostos por base: %2")
+            .arg(now[Profile::MR_CALLS]).arg(rejected.join(" / ")));
+        m_profileLast = now;
+    }
+
+    void showPrimePi(uint64_t x, uint64_t pi, double seconds)
+    {
+        QString text = QString::number(pi);
+        if (x >= 2)
+            text += QString("  (Li − π = %1)").arg(static_cast<double>(offsetLogIntegral(x) - pi), 0, 'f', 1);
+        text += QString("  %1 s").arg(seconds, 0, 'f', 2);
+        // x = n atual de uma varredura de primos desde o início: o crivo só
+        // não enumera 2, 3, 5, 7
+        if (x == m_lastCurrentN && m_runMode != AnalysisMode::Twins && m_scanStartN <= 11) {
+            uint64_t scanned = m_lastPrimeCount;
+            for (uint64_t q : {2, 3, 5, 7})
+                if (q >= m_scanStartN) ++scanned;
+            text += scanned == pi ? "  ✓ confere" : QString("  ✗ varredura: %1").arg(scanned);
+        }
+        m_labelPiLmo->setText(text);
+        m_log->append(QString("π(%1) = %2 [LMO, %3 s]").arg(x).arg(pi).arg(seconds, 0, 'f', 2));
+    }
+
+    // Cria a linha da década 10^(row + 3) na tabela de convergência
+    void ensureConvergenceRow(int row)
+    {
+        static const char *const superscript[] = {"⁰", "¹", "²", "³", "⁴", "⁵", "⁶", "⁷", "⁸", "⁹"};
+        while (m_convergenceTable->rowCount() <= row) {
+            const int i = m_convergenceTable->rowCount();
+            QString label = "10";
+            for (char c : std::to_string(i + LogBinLayout::FIRST_DECADE))
+                label += superscript[c - '0'];
+            m_convergenceTable->setRowCount(i + 1);
+            m_convergenceTable->setItem(i, 0, new QTableWidgetItem(label));
+            for (int j = 1; j < 5; ++j) {
+                auto *item = new QTableWidgetItem("-");
+                item->setTextAlignment(Qt::AlignCenter);
+                m_convergenceTable->setItem(i, j, item);
+            }
+        }
+    }
+
+    // Checkpoint da GUI: um único arquivo no diretório de dados do usuário
+    static QString checkpointPath()
+    {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        return dir + "/scan.ckpt";
+    }
+
+    // Registros por twin da GUI, ao lado do checkpoint
+    static QString twinExportPath()
+    {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        return dir + "/twins.tcol";
+    }
+
+    // Cria o Worker numa QThread própria; ckpt != nullptr retoma a varredura
+    void startWorker(const ScanCheckpoint *ckpt, uint64_t startN)
+    {
+        m_lastLogBlock = 0;
+        m_recordsLogged[0] = m_recordsLogged[1] = SIZE_MAX;
+        m_kTChart->clear();
+        m_ratioChart->clear();
+        m_v2Chart->clear();
+        m_scanStartN = startN;
+        Profile::reset();
+        m_profileLast = Profile::Snapshot{};
+        m_profileClock.start();
+        m_snapshotsTaken = m_snapshotsAtLast = 0;
+        if (m_runMode == AnalysisMode::Twins) {
+            // O crivo de pares não enumera primos: sem estatísticas de primos
+            for (QLabel *label : {m_labelPrimeCount, m_labelAvgPrimeGap, m_labelkTPrimeEmp,
+                                  m_labelkTPrimeTheo, m_labelkTPrimeError, m_labelMeanV2,
+                                  m_labelV2P1, m_labelV2P2, m_labelV2P3,
+                                  m_recordLabels[0][0], m_recordLabels[0][1],
+                                  m_recordLabels[0][2], m_recordLabels[0][3]})
+                label->setText("-");
+        } else if (m_runMode == AnalysisMode::Primes) {
+            // O modo Primes não acumula twins (só os procura para a exportação)
+            for (QLabel *label : {m_labelTwinCount, m_labelAvgTwinGap, m_labelkTTwinEmp,
+                                  m_labelkTTwinAsymptotic, m_labelkTTwinTheo, m_labelkTRatio,
+                                  m_labelkTTwinError, m_labelMeanV2Gap, m_labelV2GapP1,
+                                  m_labelV2GapP2, m_labelV2GapP3, m_labelCorrV2,
+                                  m_labelBoltzmannR2, m_recordLabels[1][0], m_recordLabels[1][1],
+                                  m_recordLabels[1][2], m_recordLabels[1][3]})
+                label->setText("-");
+        }
+
+        m_workerThread = new QThread(this);
+        m_worker = new Worker();
+        if (ckpt)
+            m_worker->resume(*ckpt, m_multiThreadCheck->isChecked());
+        else
+            m_worker->configure(startN, m_runMode, m_multiThreadCheck->isChecked());
+        m_worker->setCheckpointFile(checkpointPath());
+        if (m_exportCheck->isChecked())
+            m_worker->setTwinExportFile(twinExportPath());
+        m_worker->moveToThread(m_workerThread);
+        m_snapshots = m_worker->snapshots();
+
+        connect(m_workerThread, &QThread::started, m_worker, &Worker::process);
+        connect(m_worker, &Worker::checkpointFailed, this, [this](const QString &error) {
+            m_log->append("⚠ Falha ao gravar checkpoint: " + error);
+        }, Qt::QueuedConnection);
+        connect(m_worker, &Worker::exportFailed, this, [this](const QString &error) {
+            m_log->append("⚠ Falha na exportação de twins: " + error);
+        }, Qt::QueuedConnection);
+        connect(m_worker, &Worker::finished, this, &MainWindow::onFinished, Qt::QueuedConnection);
+        connect(m_worker, &Worker::finished, m_workerThread, &QThread::quit);
+        connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+        connect(m_workerThread, &QThread::finished, m_workerThread, &QObject::deleteLater);
+        connect(m_workerThread, &QThread::finished, this, [this]() {
+            m_workerThread = nullptr;
+            m_worker = nullptr;
+        });
+
+        m_workerThread->start();
+        m_refreshTimer->start(REFRESH_INTERVAL_MS);
+        m_startButton->setEnabled(false);
+        m_stopButton->setEnabled(true);
+        m_resumeButton->setEnabled(false);
+    }
+
     void cleanupWorker()
     {
         if (m_worker) m_worker->stop();
@@ -1169,12 +1313,19 @@ private:
             m_workerThread->quit();
             m_workerThread->wait(3000);
         }
+        if (m_piCounter) m_piCounter->stop();
+        if (m_piThread) m_piThread->wait();
     }
 
     QLineEdit *m_startEdit;
     QComboBox *m_modeCombo;
-    QPushButton *m_startButton, *m_stopButton, *m_resetButton;
+    QCheckBox *m_multiThreadCheck;
+    QCheckBox *m_exportCheck;
+    QPushButton *m_startButton, *m_stopButton, *m_resetButton, *m_resumeButton;
     QLabel *m_labelCurrentN, *m_labelPrimeCount, *m_labelTwinCount;
+    QLineEdit *m_piEdit;
+    QPushButton *m_piButton;
+    QLabel *m_labelPiLmo;
     QLabel *m_labelAvgPrimeGap, *m_labelkTPrimeEmp, *m_labelkTPrimeTheo, *m_labelkTPrimeError;
     QLabel *m_labelRegime;
     QLabel *m_labelAvgTwinGap, *m_labelkTTwinEmp, *m_labelkTTwinAsymptotic;
@@ -1184,17 +1335,1161 @@ private:
     QLabel *m_labelV2GapP1, *m_labelV2GapP2, *m_labelV2GapP3;
     QLabel *m_labelCorrV2;
     QTableWidget *m_convergenceTable;
-    QTableWidget *m_transitionTable, *m_gapTable;
+    QTableWidget *m_transitionTable, *m_gapTable, *m_fitTable;
     QLabel *m_labelBoltzmannR2;
+    QLabel *m_recordLabels[2][4];   // primos/twins × recorde, p, gap/ln²p, máx razão
+    QLabel *m_labelCandidateRate, *m_labelPrimeRate, *m_labelTwinRate;
+    QLabel *m_labelProgressRate, *m_labelPhases, *m_labelMillerRabin;
+    SeriesChart *m_kTChart, *m_ratioChart;
+    int m_kTChartBins, m_kTChartTotal, m_ratioChartBins, m_ratioChartAsymptotic;
+    V2Chart *m_v2Chart;
+    static constexpr uint64_t CHART_MIN_BIN_COUNT = 20;   // bins com menos twins são ruído
     QTextEdit *m_log, *m_mathInfo;
     QThread *m_workerThread = nullptr;
     Worker *m_worker = nullptr;
+    // A janela atualiza a 10 Hz, independente do ritmo da varredura
+    static constexpr int REFRESH_INTERVAL_MS = 100;
+    QTimer *m_refreshTimer;
+    std::shared_ptr<SnapshotBuffer<Stats>> m_snapshots;
+    AnalysisMode m_runMode = AnalysisMode::Both;
+    uint64_t m_lastLogBlock = 0;
+    size_t m_recordsLogged[2] = {SIZE_MAX, SIZE_MAX};   // recordes já no log
+    uint64_t m_scanStartN = 3;
+    uint64_t m_lastCurrentN = 0, m_lastPrimeCount = 0;
+    // Painel de perfil: atualizado a cada segundo a partir dos deltas
+    static constexpr int PROFILE_INTERVAL_MS = 1000;
+    QElapsedTimer m_profileClock;
+    Profile::Snapshot m_profileLast;
+    uint64_t m_snapshotsTaken = 0, m_snapshotsAtLast = 0;
+    QThread *m_piThread = nullptr;
+    std::shared_ptr<PrimeCounter> m_piCounter;
 };
 
+// ======================= MODO BATCH (CLI) =======================
+
+// Inteiros acima de 2^53 não cabem exatamente num double JSON: vão como string
+static QJsonValue jsonU64(uint64_t v)
+{
+    if (v < (uint64_t(1) << 53)) return QJsonValue(static_cast<double>(v));
+    return QJsonValue(QString::number(v));
+}
+
+// Idem para 128 bits: string a partir de 2⁵³
+static QJsonValue jsonU128(uint128_t v)
+{
+    if (v <= UINT64_MAX) return jsonU64(static_cast<uint64_t>(v));
+    return QJsonValue(QString::fromStdString(toDecimal(v)));
+}
+
+static QJsonArray jsonHistogram(const uint64_t (&h)[8])
+{
+    QJsonArray arr;
+    for (uint64_t v : h) arr.append(jsonU64(v));
+    return arr;
+}
+
+// Gaps máximos: cada recorde com o p em que começa e gap/ln²p, e o maior gap/ln²p
+static QJsonObject jsonGapRecords(const GapRecords &r)
+{
+    QJsonArray records;
+    for (const GapRecord &g : r.records) {
+        QJsonObject rec;
+        rec["p"] = jsonU64(g.p);
+        rec["gap"] = jsonU64(g.gap);
+        rec["cramerRatio"] = g.cramerRatio();
+        records.append(rec);
+    }
+    QJsonObject o;
+    o["maxGap"] = jsonU64(r.maxGap);
+    o["records"] = records;
+    if (!r.records.empty()) {
+        const GapRecord best = r.maxRatio();
+        o["maxCramerRatio"] = best.cramerRatio();
+        o["maxCramerRatioP"] = jsonU64(best.p);
+    }
+    return o;
+}
+
+static const char *modeName(AnalysisMode mode)
+{
+    switch (mode) {
+        case AnalysisMode::Primes: return "primes";
+        case AnalysisMode::Twins: return "twins";
+        case AnalysisMode::Both: return "both";
+    }
+    return "?";
+}
+
+// Stats → JSON, só com os campos do modo de análise
+static QJsonObject statsToJson(const Stats &s, AnalysisMode mode)
+{
+    QJsonObject o;
+    o["currentN"] = jsonU64(s.currentN);
+    o["regime"] = regimeName(s.regime);
+
+    if (mode != AnalysisMode::Twins) {
+        o["primeCount"] = jsonU64(s.primeCount);
+        o["avgPrimeGap"] = s.avgPrimeGap;
+        o["kTPrimeEmpirical"] = s.kTPrimeEmpirical;
+        o["kTPrimeTheoretical"] = s.kTPrimeTheoretical;
+        o["meanV2"] = s.meanV2;
+        o["v2Histogram"] = jsonHistogram(s.v2Histogram);
+        o["primeGapRecords"] = jsonGapRecords(s.primeGapRecords);
+    }
+
+    if (mode != AnalysisMode::Primes) {
+        o["twinCount"] = jsonU64(s.twinCount);
+        o["avgTwinGap"] = s.avgTwinGap;
+        o["kTTwinEmpirical"] = s.kTTwinEmpirical;
+        o["kTTwinTheoretical"] = s.kTTwinTheoretical;
+        o["kTTwinAsymptotic"] = s.kTTwinAsymptotic;
+        o["asymptoticCount"] = jsonU64(s.asymptoticCount);
+        o["kTRatio"] = s.kTRatio;
+        o["kTBinary"] = s.kTBinary;
+        o["meanV2Gap"] = s.meanV2Gap;
+        o["v2GapHistogram"] = jsonHistogram(s.v2GapHistogram);
+        o["corrV2"] = s.corrV2;
+        o["boltzmannR2"] = s.boltzmannR2;
+        o["twinGapRecords"] = jsonGapRecords(s.twinGapRecords);
+
+        QJsonArray count, avgGap, gapMin, fits, histograms;
+        for (int c1 = 0; c1 < 3; ++c1) {
+            QJsonArray rowCount, rowAvg, rowMin, rowFit, rowHist;
+            for (int c2 = 0; c2 < 3; ++c2) {
+                rowCount.append(jsonU64(s.transitions.count[c1][c2]));
+                rowAvg.append(s.transitions.avgGap(c1, c2));
+                rowMin.append(Constants::GAP_MIN[c1][c2]);
+
+                const BoltzmannFit &f = s.boltzmannFit[c1][c2];
+                QJsonObject fit;
+                fit["kT"] = f.kT;
+                fit["kTLow"] = f.kTLow;
+                fit["kTHigh"] = f.kTHigh;
+                fit["chi2"] = f.chi2;
+                fit["dof"] = f.dof;
+                fit["pValue"] = f.pValue;
+                rowFit.append(fit);
+
+                // Histograma de (gap − gap_min)/30 até o último bin não vazio
+                const uint64_t *h = s.transitions.excessHistogram[c1][c2];
+                int last = TransitionStats::EXCESS_BINS;
+                while (last >= 0 && h[last] == 0) --last;
+                QJsonArray hist;
+                for (int k = 0; k <= last; ++k) hist.append(jsonU64(h[k]));
+                rowHist.append(hist);
+            }
+            count.append(rowCount);
+            avgGap.append(rowAvg);
+            gapMin.append(rowMin);
+            fits.append(rowFit);
+            histograms.append(rowHist);
+        }
+        QJsonObject transitions;
+        transitions["classes"] = QJsonArray{11, 17, 29};
+        transitions["count"] = count;
+        transitions["avgGap"] = avgGap;
+        transitions["gapMin"] = gapMin;
+        transitions["boltzmannFit"] = fits;
+        transitions["excessBins"] = TransitionStats::EXCESS_BINS;
+        transitions["excessHistogram"] = histograms;
+        o["transitions"] = transitions;
+
+        QJsonArray decades;
+        for (int k = LogBinLayout::FIRST_DECADE; k <= s.lastDecade(); ++k) {
+            const DecadeStats d = s.decade(k);
+            if (d.count == 0) continue;
+            QJsonObject dec;
+            dec["log10"] = k;
+            dec["count"] = jsonU64(d.count);
+            dec["kT"] = d.kT();
+            dec["avgLn2"] = d.avgLn2();
+            dec["ratio"] = d.ratio();
+            decades.append(dec);
+        }
+        o["decades"] = decades;
+
+        // Bins finos: [lower, upper), só os que têm twins
+        QJsonArray bins;
+        for (int i = 0; i < static_cast<int>(s.bins.size()); ++i) {
+            const LogBin &b = s.bins[i];
+            if (b.count == 0) continue;
+            const double ln2 = s.binLayout->meanLn2(i);
+            QJsonObject bin;
+            bin["lower"] = jsonU64(s.binLayout->lower(i));
+            bin["upper"] = jsonU64(s.binLayout->upper(i));
+            bin["count"] = jsonU64(b.count);
+            bin["kT"] = b.kT();
+            bin["avgLn2"] = ln2;
+            bin["ratio"] = b.kT() / ln2;
+            bins.append(bin);
+        }
+        o["binsPerDecade"] = s.binLayout->binsPerDecade();
+        o["bins"] = bins;
+    }
+    return o;
+}
+
+// Profile → JSON: contadores do motor e tempo por fase durante elapsed segundos
+static QJsonObject profileToJson(const Profile::Snapshot &p, double elapsed)
+{
+    QJsonObject o;
+    o["enabled"] = Profile::enabled();
+    if (!Profile::enabled()) return o;
+    o["segments"] = jsonU64(p[Profile::SEGMENTS]);
+    o["candidates"] = jsonU64(p[Profile::CANDIDATES]);
+    o["primes"] = jsonU64(p[Profile::PRIMES]);
+    o["twins"] = jsonU64(p[Profile::TWINS]);
+    o["reports"] = jsonU64(p[Profile::REPORTS]);
+    if (elapsed > 0) {
+        o["candidatesPerSecond"] = p[Profile::CANDIDATES] / elapsed;
+        o["primesPerSecond"] = p[Profile::PRIMES] / elapsed;
+        o["twinsPerSecond"] = p[Profile::TWINS] / elapsed;
+        o["reportsPerSecond"] = p[Profile::REPORTS] / elapsed;
+    }
+    QJsonObject phases;
+    for (int i = 0; i < Profile::PHASE_COUNT; ++i)
+        phases[Profile::phaseName(i)] = p.seconds(Profile::Phase(i));
+    o["phaseSeconds"] = phases;
+    o["mrCalls"] = jsonU64(p[Profile::MR_CALLS]);
+    QJsonArray rejected;
+    for (int i = 0; i < Profile::MAX_WITNESSES; ++i)
+        rejected.append(jsonU64(p.rejectedAt(i)));
+    o["mrRejectedAtWitness"] = rejected;
+    return o;
+}
+
+// TupleAccumulator → JSON: kT global, transições entre as classes mod 30 do
+// padrão e kT local por década e por bin, contra a lei kT_H = (ln p)^k / C_H
+static QJsonObject tupleStatsToJson(const TupleAccumulator &acc)
+{
+    const TupleTables::Shape &shape = *acc.shape;
+    QJsonObject o;
+    o["tupleCount"] = jsonU64(acc.count);
+    o["firstP"] = jsonU64(acc.firstP);
+    o["lastP"] = jsonU64(acc.lastP);
+    o["avgGap"] = acc.avgGap();
+    o["kT"] = acc.kT();
+    if (acc.lastP != 0)
+        o["kTTheoretical"] = acc.kTTheoretical(acc.lastP);
+
+    QJsonArray classes, count, avgGap, gapMin;
+    for (int c1 = 0; c1 < shape.classCount; ++c1) {
+        classes.append(shape.classes[c1]);
+        QJsonArray rowCount, rowAvg, rowMin;
+        for (int c2 = 0; c2 < shape.classCount; ++c2) {
+            rowCount.append(jsonU64(acc.transitionCount[c1][c2]));
+            rowAvg.append(acc.avgTransitionGap(c1, c2));
+            rowMin.append(shape.gapMin[c1][c2]);
+        }
+        count.append(rowCount);
+        avgGap.append(rowAvg);
+        gapMin.append(rowMin);
+    }
+    QJsonObject transitions;
+    transitions["classes"] = classes;
+    transitions["count"] = count;
+    transitions["avgGap"] = avgGap;
+    transitions["gapMin"] = gapMin;
+    o["transitions"] = transitions;
+
+    // ratio = kT/⟨(ln p)^k⟩; a lei prevê 1/C_H
+    const double C = static_cast<double>(shape.singularSeries);
+    QJsonArray decades;
+    for (int k = LogBinLayout::FIRST_DECADE; k <= acc.lastDecade(); ++k) {
+        const DecadeStats d = acc.decade(k);
+        if (d.count == 0) continue;
+        QJsonObject dec;
+        dec["log10"] = k;
+        dec["count"] = jsonU64(d.count);
+        dec["kT"] = d.kT();
+        dec["avgLnK"] = d.avgLn2();
+        dec["ratio"] = d.ratio();
+        dec["pctTheoretical"] = d.ratio() * C * 100.0;
+        decades.append(dec);
+    }
+    o["decades"] = decades;
+
+    QJsonArray bins;
+    for (int i = 0; i < static_cast<int>(acc.bins.size()); ++i) {
+        const LogBin &b = acc.bins[i];
+        if (b.count == 0) continue;
+        const double lnK = LogBinLayout::meanLnPow(acc.binLayout->lower(i), acc.binLayout->upper(i), shape.size);
+        QJsonObject bin;
+        bin["lower"] = jsonU64(acc.binLayout->lower(i));
+        bin["upper"] = jsonU64(acc.binLayout->upper(i));
+        bin["count"] = jsonU64(b.count);
+        bin["kT"] = b.kT();
+        bin["avgLnK"] = lnK;
+        bin["ratio"] = b.kT() / lnK;
+        bins.append(bin);
+    }
+    o["binsPerDecade"] = acc.binLayout->binsPerDecade();
+    o["bins"] = bins;
+    return o;
+}
+
+// --tuple: varre as k-uplas de Pattern com p ≥ max(start, 11) e p + h_k ≤ end
+template <class Pattern>
+static QJsonObject runTupleScan(uint64_t startN, uint64_t endN, unsigned threads,
+                                int binsPerDecade, bool showProgress)
+{
+    TupleScanner<Pattern> scanner;
+    scanner.setBinsPerDecade(binsPerDecade);
+    scanner.configure(startN, endN);
+    scanner.setThreadCount(threads);
+    QTextStream err(stderr);
+    scanner.setProgressCallback([&](const TupleAccumulator &acc) {
+        if (!showProgress) return;
+        err << "p=" << acc.lastP << " tuples=" << acc.count << "\n";
+        err.flush();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    scanner.run();
+    const double elapsed = timer.nsecsElapsed() / 1e9;
+    const TupleAccumulator &acc = scanner.result();
+
+    QJsonArray pattern;
+    for (int i = 0; i < Pattern::S.size; ++i)
+        pattern.append(Pattern::S.offsets[i]);
+    QJsonObject out;
+    out["start"] = jsonU64(startN);
+    out["end"] = jsonU64(endN);
+    out["mode"] = "tuple";
+    out["pattern"] = pattern;
+    out["singularSeries"] = static_cast<double>(Pattern::S.singularSeries);
+    out["threads"] = static_cast<int>(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    out["elapsedSeconds"] = elapsed;
+    if (elapsed > 0) {
+        out["numbersPerSecond"] = static_cast<double>(endN - startN + 1) / elapsed;
+        out["tuplesPerSecond"] = static_cast<double>(acc.count) / elapsed;
+    }
+    out["stats"] = tupleStatsToJson(acc);
+    return out;
+}
+
+// --verify-xor: classifica cada primo ímpar de [start, end] nas famílias do
+// teorema XOR, confere a assinatura K de cada um e os twins contra o TwinSieve
+static QJsonObject runXorVerification(uint64_t startN, uint64_t endN, unsigned threads, bool showProgress)
+{
+    XorVerifier verifier;
+    verifier.configure(startN, endN);
+    verifier.setThreadCount(threads);
+    QTextStream err(stderr);
+    if (showProgress) {
+        const double span = static_cast<double>(endN - startN) + 1;
+        verifier.setProgressCallback([&](uint64_t covered) {
+            err << "xor: " << QString::number(100.0 * covered / span, 'f', 1) << "%\n";
+            err.flush();
+        });
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool complete = verifier.run();
+    const double elapsed = timer.nsecsElapsed() / 1e9;
+    const XorTally &tally = verifier.result();
+
+    QJsonObject families;
+    for (int f = 0; f < XorTally::FAMILIES; ++f) {
+        // byT[i] é o número de primos da família com T = i + 1
+        int last = XorTally::MAX_T - 1;
+        while (last > 0 && tally.byT[f][last] == 0) --last;
+        QJsonArray byT;
+        for (int t = 1; t <= last; ++t) byT.append(jsonU64(tally.byT[f][t]));
+        QJsonObject family;
+        family["count"] = jsonU64(tally.familyCount(f));
+        family["byT"] = byT;
+        families[XorTally::familyName(f)] = family;
+    }
+    auto toArray = [](const std::vector<uint64_t> &list) {
+        QJsonArray array;
+        for (uint64_t p : list) array.append(jsonU64(p));
+        return array;
+    };
+    QJsonObject counterexamples;
+    counterexamples["primeSieveOnly"] = toArray(tally.primeSieveOnly);
+    counterexamples["twinSieveOnly"] = toArray(tally.twinSieveOnly);
+
+    QJsonObject out;
+    out["mode"] = "verify-xor";
+    out["start"] = jsonU64(startN);
+    out["end"] = jsonU64(endN);
+    out["threads"] = static_cast<int>(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    out["complete"] = complete;
+    out["elapsedSeconds"] = elapsed;
+    if (elapsed > 0) {
+        out["numbersPerSecond"] = static_cast<double>(endN - startN + 1) / elapsed;
+        out["primesPerSecond"] = static_cast<double>(tally.primes) / elapsed;
+    }
+    out["primes"] = jsonU64(tally.primes);
+    out["families"] = families;
+    out["twinMismatches"] = jsonU64(tally.twinMismatches);
+    out["counterexamples"] = counterexamples;
+    out["verified"] = complete && tally.twinMismatches == 0;
+    return out;
+}
+
+// Opções que colocam o programa em modo batch (sem GUI)
+static bool isBatchInvocation(int argc, char **argv)
+{
+    static const char *const options[] = {
+        "--start", "--end", "--mode", "--threads", "--output", "--progress",
+        "--checkpoint", "--checkpoint-interval", "--resume", "--bins-per-decade", "--pi",
+        "--pi-only", "--sample-from", "--sample-to", "--samples-per-decade", "--sample-width", "--tuple",
+        "--export-twins", "--reanalyze", "--segment-cache", "--cache-budget", "--verify-xor", "--help"
+    };
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        for (const char *opt : options) {
+            if (arg == opt || arg.startsWith(QByteArray(opt) + '='))
+                return true;
+        }
+    }
+    return false;
+}
+
+// π(x) pelo PrimeCounter, com Li(x) e o tempo gasto
+static QJsonObject primePiToJson(uint64_t x, unsigned threads, uint64_t &pi)
+{
+    PrimeCounter counter;
+    counter.setThreadCount(threads);
+    QElapsedTimer timer;
+    timer.start();
+    pi = counter.count(x);
+    QJsonObject o;
+    o["x"] = jsonU64(x);
+    o["value"] = jsonU64(pi);
+    if (x >= 2) o["li"] = static_cast<double>(offsetLogIntegral(x));
+    o["seconds"] = timer.nsecsElapsed() / 1e9;
+    return o;
+}
+
+// Varredura limitada sem QApplication: roda o Scanner na thread principal e
+// grava as Stats finais em JSON (stdout ou --output)
+static int runBatch(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("thermodynamics");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Termodinâmica dos Primos — modo batch (sem GUI)");
+    parser.addHelpOption();
+    QCommandLineOption startOpt("start", "Primeiro n da varredura (padrão 3).", "n", "3");
+    QCommandLineOption endOpt("end", "Último n da varredura, inclusive (obrigatório).", "n");
+    QCommandLineOption modeOpt("mode", "primes | twins | both (padrão both).", "mode", "both");
+    QCommandLineOption threadsOpt("threads", "Threads; 0 = uma por núcleo (padrão), 1 = sequencial.", "n", "0");
+    QCommandLineOption outputOpt("output", "Grava o JSON neste arquivo em vez de stdout.", "file");
+    QCommandLineOption progressOpt("progress", "Mostra o progresso em stderr.");
+    QCommandLineOption checkpointOpt("checkpoint", "Grava checkpoints periódicos neste arquivo.", "file");
+    QCommandLineOption intervalOpt("checkpoint-interval", "Segundos entre checkpoints (padrão 60).", "s", "60");
+    QCommandLineOption resumeOpt("resume", "Continua do --checkpoint, se ele existir.");
+    QCommandLineOption binsOpt("bins-per-decade", "Bins logarítmicos por década do kT local (padrão 100).",
+                               "n", QString::number(LogBinLayout::DEFAULT_BINS_PER_DECADE));
+    QCommandLineOption piOpt("pi", "Calcula também π(end) pelo método combinatório (LMO) e confere a contagem.");
+    QCommandLineOption piOnlyOpt("pi-only", "Só calcula π(end) pelo método combinatório, sem varrer.");
+    QCommandLineOption sampleFromOpt("sample-from", "Amostra janelas isoladas (modo twins) a partir deste centro (até 2¹²⁸; aceita 1e20).", "n");
+    QCommandLineOption sampleToOpt("sample-to", "Último centro de janela (padrão: --sample-from).", "n");
+    QCommandLineOption samplesOpt("samples-per-decade", "Centros log-espaçados por década (padrão 4).", "k", "4");
+    QCommandLineOption sampleWidthOpt("sample-width", "Largura de cada janela (padrão 10⁸).", "n", "100000000");
+    QCommandLineOption tupleOpt("tuple", "Varre as k-uplas do padrão H em vez de --mode: 0,2 | 0,4 | 0,6 | 0,2,6 | 0,4,6 | 0,2,6,8.", "H");
+    QCommandLineOption exportOpt("export-twins", "Grava um registro por twin (p, classe mod 30, v₂(p+1), gap) neste arquivo colunar.", "file");
+    QCommandLineOption reanalyzeOpt("reanalyze", "Recalcula as estatísticas de twins de um arquivo de --export-twins, sem crivar.", "file");
+    QCommandLineOption cacheOpt("segment-cache", "Cache persistente dos segmentos crivados (modos primes e both).", "file");
+    QCommandLineOption budgetOpt("cache-budget", "Tamanho máximo do --segment-cache em MiB (padrão 4096).", "MiB", "4096");
+    QCommandLineOption xorOpt("verify-xor", "Verifica o teorema XOR das três famílias para os primos de [start, end], sem varrer.");
+    parser.addOptions({startOpt, endOpt, modeOpt, threadsOpt, outputOpt, progressOpt,
+                       checkpointOpt, intervalOpt, resumeOpt, binsOpt, piOpt, piOnlyOpt,
+                       sampleFromOpt, sampleToOpt, samplesOpt, sampleWidthOpt, tupleOpt,
+                       exportOpt, reanalyzeOpt, cacheOpt, budgetOpt, xorOpt});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    auto fail = [&](const QString &msg) {
+        err << "erro: " << msg << "\n";
+        return 2;
+    };
+    auto write = [&](const QJsonObject &out) {
+        const QByteArray json = QJsonDocument(out).toJson(QJsonDocument::Indented);
+        if (parser.isSet(outputOpt)) {
+            QFile file(parser.value(outputOpt));
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                fail("não foi possível gravar " + file.fileName());
+                return 1;
+            }
+            file.write(json);
+        } else {
+            QTextStream(stdout) << json;
+        }
+        return 0;
+    };
+
+    bool okStart = false, okEnd = false, okThreads = false, okInterval = false;
+    uint64_t startN = parser.value(startOpt).toULongLong(&okStart);
+    uint64_t endN = parser.value(endOpt).toULongLong(&okEnd);
+    const unsigned threads = parser.value(threadsOpt).toUInt(&okThreads);
+    const int interval = parser.value(intervalOpt).toInt(&okInterval);
+    bool okBins = false;
+    const int binsPerDecade = parser.value(binsOpt).toInt(&okBins);
+    if (!okBins || binsPerDecade < 1 || binsPerDecade > LogBinLayout::MAX_BINS_PER_DECADE)
+        return fail(QString("--bins-per-decade deve estar entre 1 e %1").arg(LogBinLayout::MAX_BINS_PER_DECADE));
+    const QString checkpointFile = parser.value(checkpointOpt);
+    if (parser.isSet(resumeOpt) && checkpointFile.isEmpty())
+        return fail("--resume exige --checkpoint");
+    if (!okInterval || interval < 1)
+        return fail("--checkpoint-interval inválido");
+
+    AnalysisMode mode;
+    const QString modeArg = parser.value(modeOpt).toLower();
+    if (modeArg == "primes") mode = AnalysisMode::Primes;
+    else if (modeArg == "twins") mode = AnalysisMode::Twins;
+    else if (modeArg == "both") mode = AnalysisMode::Both;
+    else return fail("--mode deve ser primes, twins ou both");
+
+    // Reanálise: as Stats de twins saem do arquivo mapeado, sem crivo
+    if (parser.isSet(reanalyzeOpt)) {
+        QElapsedTimer timer;
+        timer.start();
+        TwinExportReader reader;
+        std::string error;
+        if (!reader.open(parser.value(reanalyzeOpt).toStdString(), &error))
+            return fail(QString::fromStdString(error));
+        ScanAccumulator acc(LogBinLayout::get(binsPerDecade));
+        reader.forEach([&](uint64_t p, uint8_t, uint8_t, uint32_t) { acc.addTwinPair(p); });
+        Stats stats;
+        acc.fillStats(stats, acc.lastN());
+
+        QJsonObject out;
+        out["mode"] = "reanalyze";
+        out["records"] = jsonU64(reader.recordCount());
+        out["blocks"] = static_cast<int>(reader.blocks().size());
+        out["elapsedSeconds"] = timer.nsecsElapsed() / 1e9;
+        out["stats"] = statsToJson(stats, AnalysisMode::Twins);
+        return write(out);
+    }
+    const QString exportFile = parser.value(exportOpt);
+
+    // k-uplas de um padrão H: varredura própria, sem checkpoints
+    if (parser.isSet(tupleOpt)) {
+        std::vector<int> offsets;
+        for (const QString &part : parser.value(tupleOpt).split(',')) {
+            bool ok = false;
+            offsets.push_back(part.trimmed().toInt(&ok));
+            if (!ok) return fail("--tuple deve ser uma lista de offsets, ex. 0,2,6");
+        }
+        if (parser.isSet(sampleFromOpt) || !checkpointFile.isEmpty() || parser.isSet(resumeOpt)
+            || !exportFile.isEmpty())
+            return fail("--tuple não combina com --sample-from, --checkpoint, --resume ou --export-twins");
+        if (!parser.isSet(endOpt))
+            return fail("--end é obrigatório no modo batch");
+        if (!okStart || !okEnd || startN < 2 || endN < startN)
+            return fail("intervalo inválido");
+        if (!okThreads)
+            return fail("número de threads inválido");
+
+        QJsonObject out;
+        const bool known = visitTuplePattern(offsets, [&](auto pattern) {
+            out = runTupleScan<decltype(pattern)>(startN, endN, threads, binsPerDecade,
+                                                  parser.isSet(progressOpt));
+        });
+        if (!known)
+            return fail("--tuple: padrão sem crivo instanciado (0,2 | 0,4 | 0,6 | 0,2,6 | 0,4,6 | 0,2,6,8)");
+        return write(out);
+    }
+
+    // Teorema XOR: contagem por família e por T, sem acumuladores
+    if (parser.isSet(xorOpt)) {
+        if (parser.isSet(sampleFromOpt) || !checkpointFile.isEmpty() || parser.isSet(resumeOpt)
+            || !exportFile.isEmpty())
+            return fail("--verify-xor não combina com --sample-from, --checkpoint, --resume ou --export-twins");
+        if (!parser.isSet(endOpt))
+            return fail("--end é obrigatório no modo batch");
+        if (!okStart || !okEnd || startN < 2 || endN < startN)
+            return fail("intervalo inválido");
+        if (!okThreads)
+            return fail("número de threads inválido");
+        return write(runXorVerification(startN, endN, threads, parser.isSet(progressOpt)));
+    }
+
+    // Amostragem: janelas independentes em vez de uma varredura cumulativa
+    if (parser.isSet(sampleFromOpt)) {
+        if (!exportFile.isEmpty())
+            return fail("--export-twins não se aplica a --sample-from");
+        bool okTo = true, okPer = false, okWidth = false;
+        uint128_t from = 0, to = 0;
+        const bool okFrom = parseDecimal(parser.value(sampleFromOpt).toStdString(), from);
+        if (parser.isSet(sampleToOpt))
+            okTo = parseDecimal(parser.value(sampleToOpt).toStdString(), to);
+        else
+            to = from;
+        const int perDecade = parser.value(samplesOpt).toInt(&okPer);
+        const uint64_t width = parser.value(sampleWidthOpt).toULongLong(&okWidth);
+        if (!okFrom || !okTo || from < 3 || to < from)
+            return fail("--sample-from/--sample-to inválidos");
+        if (!okPer || perDecade < 1 || perDecade > 1000)
+            return fail("--samples-per-decade deve estar entre 1 e 1000");
+        if (!okWidth || width < 1000)
+            return fail("--sample-width deve ser ao menos 1000");
+        if (!okThreads)
+            return fail("número de threads inválido");
+
+        WindowSampler sampler;
+        sampler.configure(WindowSampler::logCenters(from, to, perDecade), width);
+        sampler.setThreadCount(threads);
+        QJsonArray windows;
+        const bool showProgress = parser.isSet(progressOpt);
+        sampler.setWindowCallback([&](const SampleWindow &w) {
+            QJsonObject o;
+            o["center"] = jsonU128(w.center);
+            o["start"] = jsonU128(w.start);
+            o["end"] = jsonU128(w.end);
+            o["twinCount"] = jsonU64(w.twinCount);
+            o["transitions"] = jsonU64(w.local.count);
+            o["kT"] = w.local.kT();
+            o["avgLn2"] = w.local.avgLn2();
+            o["ratio"] = w.local.ratio();
+            o["pctTheoretical"] = w.local.pctTheoretical();
+            o["seconds"] = w.seconds;
+            windows.append(o);
+            if (showProgress) {
+                err << "janela " << windows.size() << "/" << sampler.windows().size()
+                    << " centro=" << QString::fromStdString(toDecimal(w.center)) << " kT/ln²p=" << w.local.ratio() << "\n";
+                err.flush();
+            }
+        });
+
+        QElapsedTimer timer;
+        timer.start();
+        sampler.run();
+
+        QJsonObject out;
+        out["mode"] = "windows";
+        out["sampleWidth"] = jsonU64(width);
+        out["samplesPerDecade"] = perDecade;
+        out["threads"] = static_cast<int>(threads == 0 ? std::thread::hardware_concurrency() : threads);
+        out["elapsedSeconds"] = timer.nsecsElapsed() / 1e9;
+        out["windows"] = windows;
+        return write(out);
+    }
+
+    // Retomada: intervalo e modo vêm do checkpoint; as opções dadas precisam
+    // concordar com ele. Sem arquivo, a varredura começa do zero.
+    ScanCheckpoint ckpt;
+    const bool resuming = parser.isSet(resumeOpt) && QFile::exists(checkpointFile);
+    if (resuming) {
+        std::string error;
+        if (!ckpt.load(checkpointFile.toStdString(), &error))
+            return fail(checkpointFile + ": " + QString::fromStdString(error));
+        if ((parser.isSet(startOpt) && startN != ckpt.startN)
+            || (parser.isSet(endOpt) && endN != ckpt.endN)
+            || (parser.isSet(modeOpt) && mode != ckpt.mode)
+            || (parser.isSet(binsOpt) && binsPerDecade != ckpt.acc.binLayout->binsPerDecade()))
+            return fail("--start, --end, --mode e --bins-per-decade devem coincidir com o checkpoint");
+        if (ckpt.endN == UINT64_MAX)
+            return fail("o checkpoint é de uma varredura sem fim (GUI); use --end");
+        startN = ckpt.startN;
+        endN = ckpt.endN;
+        mode = ckpt.mode;
+    } else {
+        if (!parser.isSet(endOpt))
+            return fail("--end é obrigatório no modo batch");
+        if (!okStart || !okEnd || startN < 2 || endN < startN)
+            return fail("intervalo inválido");
+    }
+    if (!okThreads)
+        return fail("número de threads inválido");
+
+    // π(end) além da fronteira da varredura: nada a enumerar
+    if (parser.isSet(piOnlyOpt)) {
+        uint64_t pi = 0;
+        QJsonObject out;
+        out["threads"] = static_cast<int>(threads == 0 ? std::thread::hardware_concurrency() : threads);
+        out["primePi"] = primePiToJson(endN, threads, pi);
+        return write(out);
+    }
+
+    Scanner scanner;
+    scanner.setBinsPerDecade(binsPerDecade);
+    if (resuming)
+        scanner.resume(ckpt, threads != 1);
+    else
+        scanner.configure(startN, mode, threads != 1, endN);
+    scanner.setThreadCount(threads);
+    if (!checkpointFile.isEmpty())
+        scanner.setCheckpointFile(checkpointFile.toStdString(), interval);
+    scanner.setCheckpointErrorCallback([&](const std::string &error) {
+        err << "aviso: falha ao gravar checkpoint: " << QString::fromStdString(error) << "\n";
+        err.flush();
+    });
+    if (!exportFile.isEmpty())
+        scanner.setTwinExportFile(exportFile.toStdString());
+
+    // Segmentos já crivados por execuções anteriores vêm do cache
+    SegmentCache cache;
+    const QString cacheFile = parser.value(cacheOpt);
+    if (!cacheFile.isEmpty()) {
+        bool okBudget = false;
+        const uint64_t budgetMiB = parser.value(budgetOpt).toULongLong(&okBudget);
+        if (!okBudget || budgetMiB < 1)
+            return fail("--cache-budget inválido");
+        std::string error;
+        if (!cache.open(cacheFile.toStdString(), budgetMiB << 20, PrimeSieve::SEGMENT_WORDS * 8, &error))
+            return fail(QString::fromStdString(error));
+        if (cache.previousCapacity() != 0)
+            err << "aviso: --cache-budget mudou; cache redimensionado de " << cache.previousCapacity()
+                << " para " << cache.capacity() << " segmentos, " << cache.size() << " mantidos\n";
+        if (mode == AnalysisMode::Twins)
+            err << "aviso: --segment-cache não se aplica ao modo twins\n";
+        scanner.setSegmentCache(&cache);
+    }
+    scanner.setExportErrorCallback([&](const std::string &error) {
+        err << "aviso: falha na exportação de twins: " << QString::fromStdString(error) << "\n";
+        err.flush();
+    });
+
+    // Só o trecho varrido nesta execução entra nas taxas
+    const uint64_t runStart = resuming ? std::max(ckpt.nextN, startN) : startN;
+    const uint64_t priorPrimes = resuming ? ckpt.acc.primeCount : 0;
+    const uint64_t priorTwins = resuming ? ckpt.acc.twinCount : 0;
+
+    Stats last;
+    const bool showProgress = parser.isSet(progressOpt);
+    scanner.setProgressCallback([&](const Stats &s) {
+        last = s;
+        if (showProgress) {
+            err << "n=" << s.currentN << " primes=" << s.primeCount
+                << " twins=" << s.twinCount << "\n";
+            err.flush();
+        }
+    });
+
+    QElapsedTimer timer;
+    Profile::reset();
+    timer.start();
+    scanner.run();
+    const double elapsed = timer.nsecsElapsed() / 1e9;
+
+    QJsonObject out;
+    out["start"] = jsonU64(startN);
+    out["end"] = jsonU64(endN);
+    out["mode"] = modeName(mode);
+    out["threads"] = static_cast<int>(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    if (resuming)
+        out["resumedFrom"] = jsonU64(runStart);
+    if (!exportFile.isEmpty())
+        out["twinExport"] = exportFile;
+    if (cache.isOpen()) {
+        const SegmentCache::Counters c = cache.counters();
+        QJsonObject cacheJson;
+        cacheJson["file"] = cacheFile;
+        cacheJson["capacitySegments"] = jsonU64(cache.capacity());
+        if (cache.previousCapacity() != 0)
+            cacheJson["resizedFromSegments"] = jsonU64(cache.previousCapacity());
+        cacheJson["hits"] = jsonU64(c.hits);
+        cacheJson["misses"] = jsonU64(c.misses);
+        cacheJson["evictions"] = jsonU64(c.evictions);
+        out["segmentCache"] = cacheJson;
+    }
+    out["elapsedSeconds"] = elapsed;
+    if (elapsed > 0) {
+        const uint64_t scanned = endN >= runStart ? endN - runStart + 1 : 0;
+        out["numbersPerSecond"] = static_cast<double>(scanned) / elapsed;
+        if (mode != AnalysisMode::Twins)
+            out["primesPerSecond"] = static_cast<double>(last.primeCount - priorPrimes) / elapsed;
+        if (mode != AnalysisMode::Primes)
+            out["twinsPerSecond"] = static_cast<double>(last.twinCount - priorTwins) / elapsed;
+    }
+    out["stats"] = statsToJson(last, mode);
+    out["profile"] = profileToJson(Profile::snapshot(), elapsed);
+
+    // O crivo não enumera 2, 3, 5, 7: a contagem da varredura deve ser
+    // π(end) − π(start − 1) menos os que estão no intervalo
+    if (parser.isSet(piOpt)) {
+        uint64_t pi = 0;
+        QJsonObject piJson = primePiToJson(endN, threads, pi);
+        if (mode != AnalysisMode::Twins) {
+            uint64_t scanned = last.primeCount;
+            for (uint64_t q : {2, 3, 5, 7})
+                if (q >= startN && q <= endN) ++scanned;
+            const uint64_t expected = pi - (startN > 1 ? primePi(startN - 1, threads) : 0);
+            piJson["scanCount"] = jsonU64(scanned);
+            piJson["matchesScan"] = scanned == expected;
+        }
+        out["primePi"] = piJson;
+    }
+    return write(out);
+}
+
+// ======================= BENCHMARKS (CLI) =======================
+
+// Entradas pseudo-aleatórias fixas (splitmix64): os mesmos números em toda execução
+static uint64_t benchRandom(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Impede o compilador de fundir ou eliminar o laço medido
+static inline void benchKeep(uint64_t &v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : "+r"(v));
+#else
+    volatile uint64_t sink = v;
+    v = sink;
+#endif
+}
+
+// count candidatos da wheel (coprimos com 210) em [lo, lo + span);
+// primesOnly filtra só os primos (pior caso do Miller-Rabin: todas as bases)
+static std::vector<uint64_t> benchCandidates(uint64_t lo, uint64_t span, size_t count,
+                                             bool primesOnly = false)
+{
+    std::vector<uint64_t> v;
+    uint64_t state = lo ^ span;
+    while (v.size() < count) {
+        const uint64_t r = lo + benchRandom(state) % span;
+        const uint64_t n = r / 210 * 210 + Constants::WHEEL_OFFSETS[r % Constants::WHEEL_SIZE];
+        if (n < lo || n - lo >= span || n < 11) continue;
+        if (primesOnly && !MillerRabin::isPrime(n)) continue;
+        v.push_back(n);
+    }
+    return v;
+}
+
+// Repete body() (opsPerCall operações por chamada) por ao menos 0,2 s.
+// checksum é o retorno da última chamada: muda só se o resultado mudar.
+template <class F>
+static QJsonObject benchKernel(const char *name, const char *input, uint64_t opsPerCall, F body)
+{
+    volatile uint64_t checksum = body();   // aquecimento
+    QElapsedTimer timer;
+    timer.start();
+    uint64_t calls = 0;
+    do {
+        checksum = body();
+        ++calls;
+    } while (timer.nsecsElapsed() < 200000000);
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    const uint64_t ops = calls * opsPerCall;
+
+    QJsonObject o;
+    o["bench"] = "kernel";
+    o["name"] = name;
+    o["input"] = input;
+    o["ops"] = jsonU64(ops);
+    o["seconds"] = seconds;
+    o["nsPerOp"] = seconds * 1e9 / ops;
+    o["opsPerSecond"] = ops / seconds;
+    o["checksum"] = jsonU64(checksum);
+    return o;
+}
+
+// Percorre span números a partir de 10¹² com o wheel mod M. tableBytes é o
+// que o laço lê (um passo por resíduo); candidatesPerNumber = φ(M)/M.
+template <int M>
+static QJsonObject benchWheel(uint64_t span)
+{
+    using W = Constants::Wheel<M>;
+    const QByteArray name = "WheelIteratorMod<" + QByteArray::number(M) + ">::next";
+    const uint64_t lo = 1000000000000ULL;
+    QJsonObject o = benchKernel(name.constData(), "from-1e12", span, [span, lo] {
+        WheelIteratorMod<M> it(lo);
+        uint64_t sum = 0;
+        for (; it.current() < lo + span; it.next()) {
+            sum += it.current();
+            benchKeep(sum);
+        }
+        return sum;
+    });
+    o["tableBytes"] = int(sizeof(W::T.deltas));
+    o["candidatesPerNumber"] = double(W::SIZE) / M;
+    return o;
+}
+
+static void benchKernels(const std::function<void(const QJsonObject &)> &emitLine)
+{
+    const size_t N = 4096;
+
+    // Miller-Rabin isolado: entradas típicas (a maioria composta) e só primos
+    const auto u32 = benchCandidates(1u << 31, 1u << 31, N);
+    const auto u64 = benchCandidates(uint64_t(1) << 62, uint64_t(1) << 62, N);
+    const auto p64 = benchCandidates(uint64_t(1) << 62, uint64_t(1) << 62, N, true);
+    const auto w12 = benchCandidates(1000000000000ULL, 1000000000000ULL, N);
+    const auto w18 = benchCandidates(1000000000000000000ULL, 1000000000000000000ULL, N);
+
+    auto countPrimes = [](const std::vector<uint64_t> &v, bool (*test)(uint64_t)) {
+        return [&v, test] {
+            uint64_t c = 0;
+            for (uint64_t n : v) c += test(n);
+            return c;
+        };
+    };
+    emitLine(benchKernel("MillerRabin::isPrime", "wheel-u32", N, countPrimes(u32, MillerRabin::isPrime)));
+    emitLine(benchKernel("MillerRabin::isPrime", "wheel-u64", N, countPrimes(u64, MillerRabin::isPrime)));
+    emitLine(benchKernel("MillerRabin::isPrime", "primes-u64", N, countPrimes(p64, MillerRabin::isPrime)));
+    emitLine(benchKernel("MillerRabin::isPrimeFromWheel", "wheel-1e12", N,
+                         countPrimes(w12, MillerRabin::isPrimeFromWheel)));
+    emitLine(benchKernel("MillerRabin::isPrimeFromWheel", "wheel-1e18", N,
+                         countPrimes(w18, MillerRabin::isPrimeFromWheel)));
+
+    std::vector<uint8_t> out(N);
+    auto batch = [&out](const std::vector<uint64_t> &v) {
+        return [&v, &out] {
+            MillerRabin::isPrimeBatch(v.data(), v.size(), out.data());
+            uint64_t c = 0;
+            for (uint8_t b : out) c += b;
+            return c;
+        };
+    };
+    emitLine(benchKernel("MillerRabin::isPrimeBatch", "wheel-u32", N, batch(u32)));
+    emitLine(benchKernel("MillerRabin::isPrimeBatch", "wheel-u64", N, batch(u64)));
+    emitLine(benchKernel("MillerRabin::isPrimeBatch", "primes-u64", N, batch(p64)));
+
+    // BPSW acima de 2⁶⁴: candidatos da wheel a partir de 10²⁰ e só primos acima de 2¹⁰⁰
+    auto wideCandidates = [N](uint128_t lo, bool primesOnly) {
+        std::vector<uint128_t> v;
+        uint64_t state = static_cast<uint64_t>(lo >> 64) ^ static_cast<uint64_t>(lo);
+        while (v.size() < N) {
+            const uint128_t r = lo + benchRandom(state);
+            const uint128_t n = r / 210 * 210 + Constants::WHEEL_OFFSETS[static_cast<int>(r % Constants::WHEEL_SIZE)];
+            if (primesOnly && !BailliePSW::isPrime(n)) continue;
+            v.push_back(n);
+        }
+        return v;
+    };
+    const auto w20 = wideCandidates(uint128_t(10000000000ULL) * 10000000000ULL, false);
+    const auto p100 = wideCandidates(uint128_t(1) << 100, true);
+    for (const auto *v : {&w20, &p100}) {
+        emitLine(benchKernel("BailliePSW::isPrime", v == &w20 ? "wheel-1e20" : "primes-2^100", N, [v] {
+            uint64_t c = 0;
+            for (uint128_t n : *v) c += BailliePSW::isPrime(n);
+            return c;
+        }));
+    }
+
+    // Wheels gerados: ops = números cobertos, a mesma régua para todo M
+    const uint64_t wheelSpan = 1 << 22;
+    emitLine(benchWheel<210>(wheelSpan));
+    emitLine(benchWheel<30030>(wheelSpan));
+
+    // Janela estreita em 10¹⁸: forEachPrime/forEachTwin vão pelo caminho por
+    // teste (WheelTestSieve), que não ativa os π(10⁹) primos de crivo
+    const uint64_t narrowLo = 1000000000000000000ULL, narrowSpan = 1000000;
+    emitLine(benchKernel("forEachPrime", "narrow-1e18", narrowSpan, [&] {
+        uint64_t c = 0;
+        forEachPrime(narrowLo, narrowLo + narrowSpan - 1, [&](uint64_t) { ++c; });
+        return c;
+    }));
+    emitLine(benchKernel("forEachTwin", "narrow-1e18", narrowSpan, [&] {
+        uint64_t c = 0;
+        forEachTwin(narrowLo, narrowLo + narrowSpan - 1, [&](uint64_t) { ++c; });
+        return c;
+    }));
+
+    // Crivos sozinhos (sem acumulador): ops = números do intervalo
+    const uint64_t span = 100000000;
+    for (uint64_t lo : {uint64_t(1000000000000ULL), uint64_t(1000000000000000000ULL)}) {
+        const char *input = lo == 1000000000000ULL ? "range-1e12" : "range-1e18";
+        PrimeSieve primes;
+        emitLine(benchKernel("PrimeSieve::forEachPrime", input, span, [&] {
+            uint64_t c = 0;
+            primes.reset(lo, lo + span);
+            while (primes.nextSegment())
+                primes.forEachPrime([&](uint64_t) { ++c; });
+            return c;
+        }));
+        TwinSieve twins;
+        emitLine(benchKernel("TwinSieve::forEachTwin", input, span, [&] {
+            uint64_t c = 0;
+            twins.reset(lo, lo + span);
+            while (twins.nextSegment())
+                twins.forEachTuple([&](uint64_t) { ++c; });
+            return c;
+        }));
+        TupleSieve<TripletPattern> triplets;
+        emitLine(benchKernel("TupleSieve<0,2,6>::forEachTuple", input, span, [&] {
+            uint64_t c = 0;
+            triplets.reset(lo, lo + span);
+            while (triplets.nextSegment())
+                triplets.forEachTuple([&](uint64_t) { ++c; });
+            return c;
+        }));
+        TupleSieve<QuadrupletPattern> quadruplets;
+        emitLine(benchKernel("TupleSieve<0,2,6,8>::forEachTuple", input, span, [&] {
+            uint64_t c = 0;
+            quadruplets.reset(lo, lo + span);
+            while (quadruplets.nextSegment())
+                quadruplets.forEachTuple([&](uint64_t) { ++c; });
+            return c;
+        }));
+    }
+
+    // Janela acima de 2⁶⁴: crivo até WideTwinSieve::SIEVE_BOUND + BPSW
+    const uint64_t wideSpan = 10000000;
+    const uint128_t wideLo = uint128_t(10000000000ULL) * 10000000000ULL;
+    WideTwinSieve wide;
+    emitLine(benchKernel("WideTwinSieve::forEachTwin", "range-1e20", wideSpan, [&] {
+        uint64_t c = 0;
+        wide.reset(wideLo, wideLo + wideSpan);
+        while (wide.nextSegment())
+            wide.forEachTwin([&](uint128_t) { ++c; });
+        return c;
+    }));
+}
+
+// Varredura completa (Scanner::run) a partir de start: window números por
+// thread, para que cada thread tenha trabalho igual em qualquer escala
+static QJsonObject benchScan(AnalysisMode mode, uint64_t start, uint64_t window, unsigned threads)
+{
+    const uint64_t span = window * threads;
+    const uint64_t end = start + span - 1;
+
+    Scanner scanner;
+    scanner.configure(start, mode, threads > 1, end);
+    scanner.setThreadCount(threads);
+    Stats last;
+    scanner.setProgressCallback([&](const Stats &s) { last = s; });
+
+    QElapsedTimer timer;
+    timer.start();
+    scanner.run();
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    QJsonObject o;
+    o["bench"] = "scan";
+    o["mode"] = modeName(mode);
+    o["start"] = jsonU64(start);
+    o["numbers"] = jsonU64(end - start + 1);
+    o["threads"] = static_cast<int>(threads);
+    o["seconds"] = seconds;
+    o["numbersPerSecond"] = (end - start + 1) / seconds;
+    if (mode != AnalysisMode::Twins) {
+        o["primeCount"] = jsonU64(last.primeCount);
+        o["primesPerSecond"] = last.primeCount / seconds;
+    }
+    if (mode != AnalysisMode::Primes) {
+        o["twinCount"] = jsonU64(last.twinCount);
+        o["twinsPerSecond"] = last.twinCount / seconds;
+    }
+    return o;
+}
+
+static bool isBenchInvocation(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (QByteArray(argv[i]) == "--bench")
+            return true;
+    }
+    return false;
+}
+
+// Suíte de benchmarks: uma linha JSON por medição (JSON Lines), para comparar
+// máquinas e pegar regressões de desempenho entre versões
+static int runBench(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("thermodynamics");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Termodinâmica dos Primos — benchmarks (JSON Lines)");
+    parser.addHelpOption();
+    QCommandLineOption benchOpt("bench", "Roda a suíte de benchmarks.");
+    QCommandLineOption suiteOpt("bench-suite", "kernels | scan | all (padrão all).", "suite", "all");
+    QCommandLineOption windowOpt("bench-window", "Números por thread em cada varredura (padrão: um bloco paralelo).",
+                                 "n", QString::number(Scanner::PARALLEL_CHUNK));
+    QCommandLineOption threadsOpt("bench-threads", "Lista de threads, ex. 1,2,4 (padrão: potências de 2 até os núcleos).",
+                                  "list");
+    QCommandLineOption outputOpt("output", "Grava as linhas neste arquivo em vez de stdout.", "file");
+    parser.addOptions({benchOpt, suiteOpt, windowOpt, threadsOpt, outputOpt});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    auto fail = [&](const QString &msg) {
+        err << "erro: " << msg << "\n";
+        return 2;
+    };
+
+    const QString suite = parser.value(suiteOpt).toLower();
+    if (suite != "kernels" && suite != "scan" && suite != "all")
+        return fail("--bench-suite deve ser kernels, scan ou all");
+
+    bool okWindow = false;
+    const uint64_t window = parser.value(windowOpt).toULongLong(&okWindow);
+    if (!okWindow || window == 0)
+        return fail("--bench-window inválido");
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    if (parser.isSet(threadsOpt)) {
+        for (const QString &t : parser.value(threadsOpt).split(',')) {
+            bool ok = false;
+            const unsigned n = t.toUInt(&ok);
+            if (!ok || n == 0)
+                return fail("--bench-threads inválido");
+            threadCounts.push_back(n);
+        }
+    } else {
+        for (unsigned n = 1; n < cores; n *= 2)
+            threadCounts.push_back(n);
+        threadCounts.push_back(cores);
+    }
+
+    QFile file;
+    QTextStream out(stdout);
+    if (parser.isSet(outputOpt)) {
+        file.setFileName(parser.value(outputOpt));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fail("não foi possível gravar " + file.fileName());
+            return 1;
+        }
+        out.setDevice(&file);
+    }
+    auto emitLine = [&](const QJsonObject &o) {
+        out << QJsonDocument(o).toJson(QJsonDocument::Compact) << "\n";
+        out.flush();
+    };
+
+    QJsonObject info;
+    info["bench"] = "info";
+    info["schema"] = 1;
+    info["version"] = "4.2";
+    info["hardwareThreads"] = static_cast<int>(cores);
+    info["simd"] = MillerRabinBatch::round32Name();
+    info["parallelChunk"] = jsonU64(Scanner::PARALLEL_CHUNK);
+#ifdef __VERSION__
+    info["compiler"] = __VERSION__;
+#endif
+    emitLine(info);
+
+    if (suite != "scan")
+        benchKernels(emitLine);
+
+    if (suite != "kernels") {
+        for (uint64_t start : {uint64_t(1000000ULL), uint64_t(1000000000ULL), uint64_t(1000000000000ULL),
+                               uint64_t(1000000000000000ULL), uint64_t(1000000000000000000ULL)}) {
+            // primes contra both: o custo do lado twin sobre o mesmo PrimeSieve
+            for (AnalysisMode mode : {AnalysisMode::Both, AnalysisMode::Primes, AnalysisMode::Twins}) {
+                for (unsigned threads : threadCounts)
+                    emitLine(benchScan(mode, start, window, threads));
+            }
+        }
+    }
+    return 0;
+}
+
 // ======================= MAIN =======================
 
 int main(int argc, char **argv)
 {
+    if (isBenchInvocation(argc, argv))
+        return runBench(argc, argv);
+    if (isBatchInvocation(argc, argv))
+        return runBatch(argc, argv);
+
     QApplication app(argc, argv);
     app.setStyle("Fusion");
 